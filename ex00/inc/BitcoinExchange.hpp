@@ -19,14 +19,18 @@
 #include <fstream>
 #include <sstream>
 #include <algorithm>
+#include "SharedPriceIndex.hpp"
 
 class BitcoinExchange
 {
 private:
 	// using std::map to stock DB (date, price)
 	std::map<std::string, float> _data;
+	// optional shared index, used instead of _data once attached
+	SharedPriceIndex _shared;
 
 	bool isValidDate(const std::string &date) const;
+	bool findRate(const std::string &date, float &rate);
 
 public:
 	// canonical form
@@ -37,6 +41,10 @@ public:
 
 	void loadDatabase(const std::string &filename);
 	void processInput(const std::string &filename);
+
+	// shared memory index (see SharedPriceIndex)
+	uint64_t publishShared(const std::string &name) const;
+	void attachShared(const std::string &name);
 };
 
 #endif
\ No newline at end of file
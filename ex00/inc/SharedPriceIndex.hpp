@@ -0,0 +1,97 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   SharedPriceIndex.hpp                               :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: pol <pol@student.42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 17:40:21 by pol               #+#    #+#             */
+/*   Updated: 2026/10/19 17:40:21 by pol              ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef SHAREDPRICEINDEX_HPP
+#define SHAREDPRICEINDEX_HPP
+
+#include <map>
+#include <string>
+#include <exception>
+#include <stdint.h>
+#include <cstddef>
+
+#define PRICE_INDEX_MAGIC 0x58435442u // "BTCX"
+#define PRICE_INDEX_LAYOUT 1u
+
+/**
+ * Shared memory layout. Everything is addressed by offsets from the start of
+ * its segment, so every process can map it anywhere.
+ *
+ *   NAME       control block: which generation is current
+ *   NAME.<g>   one immutable price index per generation
+ */
+struct PriceIndexControl
+{
+	uint32_t magic;
+	uint32_t layout;
+	uint64_t generation; // 0 until something is published
+};
+
+struct PriceIndexHeader
+{
+	uint32_t magic;
+	uint32_t layout;
+	uint64_t generation;
+	uint64_t count;
+	uint64_t datesOffset;  // uint32_t[count], YYYYMMDD, ascending
+	uint64_t pricesOffset; // float[count]
+	uint64_t size;		   // whole segment, in bytes
+};
+
+/**
+ * Read-only view of a price index published in POSIX shared memory.
+ * A coordinator publishes a new generation into a fresh segment, then flips
+ * the generation in the control block. Readers check that generation on
+ * every lookup and remap when it moved; they never take a lock, and an old
+ * segment stays valid for whoever still maps it after it is unlinked.
+ */
+class SharedPriceIndex
+{
+private:
+	std::string _name;
+	const PriceIndexControl *_control;
+	const PriceIndexHeader *_header;
+	size_t _mapSize;
+	uint64_t _generation;
+
+	bool refresh();
+	void unmapData();
+
+public:
+	// canonical form (a copy attaches to the same index on its own)
+	SharedPriceIndex();
+	SharedPriceIndex(const SharedPriceIndex &other);
+	SharedPriceIndex &operator=(const SharedPriceIndex &other);
+	~SharedPriceIndex();
+
+	// Coordinator side: publishes data as the next generation, returns it
+	static uint64_t publish(const std::string &name, const std::map<std::string, float> &data);
+
+	// Worker side
+	void attach(const std::string &name);
+	void detach();
+	bool attached() const;
+	uint64_t generation() const;
+
+	// Price of the closest date not after `date`, false if there is none
+	bool floor(const std::string &date, float &price);
+
+	// "YYYY-MM-DD" -> YYYYMMDD, same order as the strings
+	static uint32_t dateKey(const std::string &date);
+
+	class ErrorException : public std::exception
+	{
+		virtual const char *what() const throw() { return "Error: shared price index unavailable."; }
+	};
+};
+
+#endif
@@ -21,6 +21,7 @@ BitcoinExchange &BitcoinExchange::operator=(const BitcoinExchange &other)
     if (this != &other)
     {
         this->_data = other._data;
+        this->_shared = other._shared;
     }
     return *this;
 }
@@ -78,6 +79,33 @@ void BitcoinExchange::loadDatabase(const std::string &filename)
     file.close();
 }
 
+// publishes the loaded database as the next generation of the shared index
+uint64_t BitcoinExchange::publishShared(const std::string &name) const
+{
+    return SharedPriceIndex::publish(name, _data);
+}
+
+// lookups go through the shared index from now on, _data is dropped
+void BitcoinExchange::attachShared(const std::string &name)
+{
+    _shared.attach(name);
+    _data.clear();
+}
+
+// rate of the closest date not after `date`
+bool BitcoinExchange::findRate(const std::string &date, float &rate)
+{
+    if (_shared.attached())
+        return _shared.floor(date, rate);
+
+    std::map<std::string, float>::iterator it = _data.upper_bound(date);
+    if (it == _data.begin())
+        return false;
+    --it;
+    rate = it->second;
+    return true;
+}
+
 void BitcoinExchange::processInput(const std::string &filename)
 {
     // 1. OPEN INPUT FILE: Open the file provided as an argument (e.g., input.txt)
@@ -147,13 +175,12 @@ void BitcoinExchange::processInput(const std::string &filename)
         else
         {
             // E. DATABASE SEARCH
-            std::map<std::string, float>::iterator it = _data.upper_bound(date);
+            float rate;
 
-            if (it != _data.begin())
+            if (findRate(date, rate))
             {
-                --it;
                 // F. OUTPUT RESULT
-                std::cout << date << " => " << val << " = " << val * it->second << std::endl;
+                std::cout << date << " => " << val << " = " << val * rate << std::endl;
             }
             else
             {
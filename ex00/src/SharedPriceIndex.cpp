@@ -0,0 +1,288 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   SharedPriceIndex.cpp                               :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: pol <pol@student.42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 17:40:25 by pol               #+#    #+#             */
+/*   Updated: 2026/10/19 17:40:25 by pol              ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "SharedPriceIndex.hpp"
+#include <algorithm>
+#include <sstream>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+SharedPriceIndex::SharedPriceIndex() : _control(NULL), _header(NULL), _mapSize(0), _generation(0) {}
+
+SharedPriceIndex::SharedPriceIndex(const SharedPriceIndex &other)
+    : _control(NULL), _header(NULL), _mapSize(0), _generation(0)
+{
+    *this = other;
+}
+
+SharedPriceIndex &SharedPriceIndex::operator=(const SharedPriceIndex &other)
+{
+    if (this != &other)
+    {
+        detach();
+        if (other.attached())
+            attach(other._name);
+    }
+    return *this;
+}
+
+SharedPriceIndex::~SharedPriceIndex() { detach(); }
+
+static std::string segmentName(const std::string &name, uint64_t generation)
+{
+    std::stringstream ss;
+    ss << name << "." << generation;
+    return ss.str();
+}
+
+static size_t align8(size_t n) { return (n + 7) & ~static_cast<size_t>(7); }
+
+uint32_t SharedPriceIndex::dateKey(const std::string &date)
+{
+    if (date.length() < 10)
+        return 0;
+    return std::atoi(date.substr(0, 4).c_str()) * 10000 + std::atoi(date.substr(5, 2).c_str()) * 100 + std::atoi(date.substr(8, 2).c_str());
+}
+
+/**
+ * PUBLISHING (coordinator)
+ *
+ * The new generation is fully written into its own segment before the
+ * control block points at it, and the previous segment is unlinked last.
+ * Only one coordinator is expected to publish under a given name.
+ */
+uint64_t SharedPriceIndex::publish(const std::string &name, const std::map<std::string, float> &data)
+{
+    // An empty index would replace a good one with "date too early" for everything
+    if (data.empty())
+        throw ErrorException();
+
+    // 1. CONTROL BLOCK: create it on first publish
+    int fd = shm_open(name.c_str(), O_RDWR | O_CREAT, 0644);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) < 0)
+        throw ErrorException();
+    if (st.st_size == 0 && ftruncate(fd, sizeof(PriceIndexControl)) < 0)
+    {
+        close(fd);
+        throw ErrorException();
+    }
+    void *map = mmap(NULL, sizeof(PriceIndexControl), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+        throw ErrorException();
+    PriceIndexControl *control = static_cast<PriceIndexControl *>(map);
+    if (control->magic != PRICE_INDEX_MAGIC)
+    {
+        control->generation = 0;
+        control->layout = PRICE_INDEX_LAYOUT;
+        control->magic = PRICE_INDEX_MAGIC;
+    }
+    uint64_t generation = __atomic_load_n(&control->generation, __ATOMIC_ACQUIRE) + 1;
+
+    // 2. NEW SEGMENT: header, then the dates, then the prices
+    uint64_t count = data.size();
+    size_t datesOffset = align8(sizeof(PriceIndexHeader));
+    size_t pricesOffset = align8(datesOffset + count * sizeof(uint32_t));
+    size_t size = pricesOffset + count * sizeof(float);
+
+    std::string segment = segmentName(name, generation);
+    shm_unlink(segment.c_str()); // leftover of a coordinator that died mid-publish
+    fd = shm_open(segment.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+    if (fd < 0 || ftruncate(fd, size) < 0)
+    {
+        if (fd >= 0)
+            close(fd);
+        munmap(map, sizeof(PriceIndexControl));
+        throw ErrorException();
+    }
+    void *dataMap = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (dataMap == MAP_FAILED)
+    {
+        shm_unlink(segment.c_str());
+        munmap(map, sizeof(PriceIndexControl));
+        throw ErrorException();
+    }
+
+    char *base = static_cast<char *>(dataMap);
+    uint32_t *dates = reinterpret_cast<uint32_t *>(base + datesOffset);
+    float *prices = reinterpret_cast<float *>(base + pricesOffset);
+    size_t i = 0;
+    for (std::map<std::string, float>::const_iterator it = data.begin(); it != data.end(); ++it, ++i)
+    {
+        dates[i] = dateKey(it->first);
+        prices[i] = it->second;
+    }
+
+    PriceIndexHeader *header = reinterpret_cast<PriceIndexHeader *>(base);
+    header->layout = PRICE_INDEX_LAYOUT;
+    header->generation = generation;
+    header->count = count;
+    header->datesOffset = datesOffset;
+    header->pricesOffset = pricesOffset;
+    header->size = size;
+    __atomic_store_n(&header->magic, PRICE_INDEX_MAGIC, __ATOMIC_RELEASE);
+    munmap(dataMap, size);
+
+    // 3. SWAP: readers pick the new generation up on their next lookup
+    __atomic_store_n(&control->generation, generation, __ATOMIC_RELEASE);
+    munmap(map, sizeof(PriceIndexControl));
+
+    // 4. CLEANUP: processes still mapping the old segment keep it alive
+    if (generation > 1)
+        shm_unlink(segmentName(name, generation - 1).c_str());
+    return generation;
+}
+
+/**
+ * READING (workers)
+ */
+void SharedPriceIndex::attach(const std::string &name)
+{
+    detach();
+
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) < 0 || static_cast<size_t>(st.st_size) < sizeof(PriceIndexControl))
+    {
+        if (fd >= 0)
+            close(fd);
+        throw ErrorException();
+    }
+    void *map = mmap(NULL, sizeof(PriceIndexControl), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+        throw ErrorException();
+
+    _name = name;
+    _control = static_cast<const PriceIndexControl *>(map);
+    if (_control->magic != PRICE_INDEX_MAGIC || _control->layout != PRICE_INDEX_LAYOUT || !refresh())
+    {
+        detach();
+        throw ErrorException();
+    }
+}
+
+void SharedPriceIndex::unmapData()
+{
+    if (_header)
+        munmap(const_cast<PriceIndexHeader *>(_header), _mapSize);
+    _header = NULL;
+    _mapSize = 0;
+    _generation = 0;
+}
+
+void SharedPriceIndex::detach()
+{
+    unmapData();
+    if (_control)
+        munmap(const_cast<PriceIndexControl *>(_control), sizeof(PriceIndexControl));
+    _control = NULL;
+    _name.clear();
+}
+
+bool SharedPriceIndex::attached() const { return _control != NULL; }
+
+uint64_t SharedPriceIndex::generation() const { return _generation; }
+
+/**
+ * Both arrays must fit between their offset and the next one, in a segment no
+ * bigger than what was mapped; the checks are written so that a corrupt count
+ * cannot overflow into passing them.
+ */
+static bool validLayout(const PriceIndexHeader &header, size_t mapped)
+{
+    if (header.size > mapped || header.datesOffset < sizeof(PriceIndexHeader) || header.datesOffset % sizeof(uint32_t)
+        || header.pricesOffset < header.datesOffset || header.pricesOffset > header.size || header.pricesOffset % sizeof(float))
+        return false;
+    return header.count <= (header.pricesOffset - header.datesOffset) / sizeof(uint32_t)
+        && header.count <= (header.size - header.pricesOffset) / sizeof(float);
+}
+
+/**
+ * Maps the current generation if it is not the one already mapped. A
+ * segment that vanished between reading the generation and opening it was
+ * superseded in the meantime, so it is retried only if the generation
+ * moved; otherwise the segment is really gone. When the new generation
+ * cannot be mapped, the one already mapped keeps serving lookups.
+ */
+bool SharedPriceIndex::refresh()
+{
+    uint64_t generation = __atomic_load_n(&_control->generation, __ATOMIC_ACQUIRE);
+
+    while (true)
+    {
+        if (generation == _generation && _header)
+            return true;
+        if (generation == 0)
+            return _header != NULL;
+
+        int fd = shm_open(segmentName(_name, generation).c_str(), O_RDONLY, 0);
+        if (fd < 0 && errno == ENOENT)
+        {
+            uint64_t current = __atomic_load_n(&_control->generation, __ATOMIC_ACQUIRE);
+            if (current != generation)
+            {
+                generation = current;
+                continue;
+            }
+        }
+        struct stat st;
+        if (fd < 0 || fstat(fd, &st) < 0 || static_cast<size_t>(st.st_size) < sizeof(PriceIndexHeader))
+        {
+            if (fd >= 0)
+                close(fd);
+            return _header != NULL;
+        }
+        size_t size = st.st_size;
+        void *map = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        if (map == MAP_FAILED)
+            return _header != NULL;
+
+        const PriceIndexHeader *header = static_cast<const PriceIndexHeader *>(map);
+        if (__atomic_load_n(&header->magic, __ATOMIC_ACQUIRE) != PRICE_INDEX_MAGIC || header->layout != PRICE_INDEX_LAYOUT
+            || header->generation != generation || !validLayout(*header, size))
+        {
+            munmap(map, size);
+            return _header != NULL;
+        }
+        unmapData();
+        _header = header;
+        _mapSize = size;
+        _generation = generation;
+        return true;
+    }
+}
+
+bool SharedPriceIndex::floor(const std::string &date, float &price)
+{
+    if (!_control || !refresh())
+        return false;
+
+    const char *base = reinterpret_cast<const char *>(_header);
+    const uint32_t *dates = reinterpret_cast<const uint32_t *>(base + _header->datesOffset);
+    const float *prices = reinterpret_cast<const float *>(base + _header->pricesOffset);
+
+    // Same as the map lookup: first date after the target, then step back
+    const uint32_t *it = std::upper_bound(dates, dates + _header->count, dateKey(date));
+    if (it == dates)
+        return false;
+    price = prices[it - dates - 1];
+    return true;
+}
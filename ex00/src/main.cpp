@@ -14,6 +14,43 @@
 
 int main(int argc, char **argv)
 {
+	std::string mode = (argc > 1) ? argv[1] : "";
+
+	// coordinator: btc --publish NAME
+	if (mode == "--publish" && argc == 3)
+	{
+		BitcoinExchange btc;
+		btc.loadDatabase("data.csv");
+		try
+		{
+			uint64_t generation = btc.publishShared(argv[2]);
+			std::cout << "published generation " << generation << std::endl;
+		}
+		catch (const std::exception &e)
+		{
+			std::cerr << e.what() << std::endl;
+			return 1;
+		}
+		return 0;
+	}
+
+	// worker: btc --attach NAME input.txt
+	if (mode == "--attach" && argc == 4)
+	{
+		BitcoinExchange btc;
+		try
+		{
+			btc.attachShared(argv[2]);
+		}
+		catch (const std::exception &e)
+		{
+			std::cerr << e.what() << std::endl;
+			return 1;
+		}
+		btc.processInput(argv[3]);
+		return 0;
+	}
+
 	// arg check
 	if (argc != 2)
 	{
@@ -26,4 +63,4 @@ int main(int argc, char **argv)
 	btc.processInput(argv[1]);
 
 	return 0;
-}
\ No newline at end of file
+}
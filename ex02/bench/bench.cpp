@@ -0,0 +1,449 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   bench.cpp                                          :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: pol <pol@student.42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 09:12:40 by pol               #+#    #+#             */
+/*   Updated: 2026/10/19 09:12:40 by pol              ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "PmergeMe.hpp"
+#include <cstdlib>
+#include <cmath>
+#include <sstream>
+#include <unistd.h>
+
+// Copies of a Record made since the last reset
+static unsigned long recordCopies = 0;
+
+// Record sorted by a string key, with a payload that should never be copied.
+// Swapping only exchanges the string and vector buffers.
+struct Record
+{
+	std::string name;
+	int score;
+	std::vector<char> payload;
+
+	Record() : score(0) {}
+	Record(const Record &src) : name(src.name), score(src.score), payload(src.payload) { recordCopies++; }
+	Record &operator=(const Record &src)
+	{
+		name = src.name;
+		score = src.score;
+		payload = src.payload;
+		recordCopies++;
+		return *this;
+	}
+	void swap(Record &other)
+	{
+		name.swap(other.name);
+		std::swap(score, other.score);
+		payload.swap(other.payload);
+	}
+};
+
+inline void swap(Record &a, Record &b) { a.swap(b); }
+
+struct RecordLess
+{
+	bool operator()(const Record &a, const Record &b) const { return a.name < b.name; }
+};
+
+struct RecordKey : public std::unary_function<Record, std::string>
+{
+	std::string operator()(const Record &r) const { return r.name; }
+};
+
+// Keys share a long prefix so every comparison has to walk most of the string
+static std::string randomKey()
+{
+	std::string s("record/2026/shard-00/");
+	for (int i = 0; i < 12; i++)
+		s += static_cast<char>('a' + std::rand() % 26);
+	return s;
+}
+
+// log2(n!), the information-theoretic minimum number of comparisons
+static double minComparisons(size_t n)
+{
+	double total = 0;
+	for (size_t i = 2; i <= n; i++)
+		total += std::log(static_cast<double>(i)) / std::log(2.0);
+	return total;
+}
+
+// Stands for a comparison count that was not measured
+#define NOT_COUNTED static_cast<unsigned long>(-1)
+
+static void report(const std::string &name, size_t n, unsigned long cmp, double us, bool ok,
+				   const std::string &extra = "")
+{
+	std::cout << std::left << std::setw(28) << name
+			  << std::right << std::setw(10) << n;
+	if (cmp == NOT_COUNTED)
+		std::cout << std::setw(14) << "-";
+	else
+		std::cout << std::setw(14) << cmp;
+	std::cout << std::setw(14) << std::fixed << std::setprecision(0) << us << " us" << extra
+			  << (ok ? "" : RED "  UNSORTED" RESET) << std::endl;
+}
+
+static std::string copies(unsigned long n)
+{
+	std::stringstream ss;
+	ss << std::setw(10) << n << " copies";
+	return ss.str();
+}
+
+template <typename T, typename Compare>
+static bool isSorted(const T &c, Compare comp)
+{
+	for (size_t i = 1; i < c.size(); i++)
+		if (comp(c[i], c[i - 1]))
+			return false;
+	return true;
+}
+
+static void benchStrings(size_t n)
+{
+	PmergeMe sorter;
+	std::vector<std::string> input;
+	for (size_t i = 0; i < n; i++)
+		input.push_back(randomKey());
+
+	std::cout << BOLD << "strings, n = " << n << ", log2(n!) = "
+			  << std::fixed << std::setprecision(0) << minComparisons(n) << RESET << std::endl;
+
+	unsigned long cmp = 0;
+	std::vector<std::string> v(input);
+	double t = monotonicUs();
+	sorter.fordJohnsonSort(v, CountingCompare<std::less<std::string> >(std::less<std::string>(), &cmp));
+	report("fordJohnsonSort (vector)", n, cmp, monotonicUs() - t, isSorted(v, std::less<std::string>()));
+
+	cmp = 0;
+	std::deque<std::string> d(input.begin(), input.end());
+	t = monotonicUs();
+	sorter.fordJohnsonSort(d, CountingCompare<std::less<std::string> >(std::less<std::string>(), &cmp));
+	report("fordJohnsonSort (deque)", n, cmp, monotonicUs() - t, isSorted(d, std::less<std::string>()));
+
+	cmp = 0;
+	v = input;
+	t = monotonicUs();
+	std::sort(v.begin(), v.end(), CountingCompare<std::less<std::string> >(std::less<std::string>(), &cmp));
+	report("std::sort", n, cmp, monotonicUs() - t, true);
+
+	cmp = 0;
+	v = input;
+	t = monotonicUs();
+	std::stable_sort(v.begin(), v.end(), CountingCompare<std::less<std::string> >(std::less<std::string>(), &cmp));
+	report("std::stable_sort", n, cmp, monotonicUs() - t, true);
+}
+
+static void benchRecords(size_t n)
+{
+	PmergeMe sorter;
+	std::vector<Record> input(n);
+	for (size_t i = 0; i < n; i++)
+	{
+		input[i].name = randomKey();
+		input[i].score = std::rand();
+		input[i].payload.resize(256);
+	}
+
+	std::cout << BOLD << "records (string key, 256 byte payload), n = " << n << RESET << std::endl;
+
+	// Copies made while setting up each run are not counted
+	unsigned long cmp = 0;
+	std::vector<Record> v(input);
+	recordCopies = 0;
+	double t = monotonicUs();
+	sorter.fordJohnsonSort(v, CountingCompare<RecordLess>(RecordLess(), &cmp));
+	report("fordJohnsonSort", n, cmp, monotonicUs() - t, isSorted(v, RecordLess()), copies(recordCopies));
+
+	// The key comparator is internal, so its comparisons are not counted
+	v = input;
+	recordCopies = 0;
+	t = monotonicUs();
+	sorter.fordJohnsonSortByKey(v, RecordKey());
+	report("fordJohnsonSortByKey", n, NOT_COUNTED, monotonicUs() - t, isSorted(v, RecordLess()), copies(recordCopies));
+
+	cmp = 0;
+	v = input;
+	recordCopies = 0;
+	t = monotonicUs();
+	std::sort(v.begin(), v.end(), CountingCompare<RecordLess>(RecordLess(), &cmp));
+	report("std::sort", n, cmp, monotonicUs() - t, true, copies(recordCopies));
+
+	cmp = 0;
+	v = input;
+	recordCopies = 0;
+	t = monotonicUs();
+	std::stable_sort(v.begin(), v.end(), CountingCompare<RecordLess>(RecordLess(), &cmp));
+	report("std::stable_sort", n, cmp, monotonicUs() - t, true, copies(recordCopies));
+}
+
+// Ford-Johnson's worst case: sum over k = 1..n of ceil(log2(3k / 4))
+static unsigned long fordJohnsonBound(size_t n)
+{
+	unsigned long total = 0;
+	for (size_t k = 1; k <= n; k++)
+	{
+		// smallest c with 3k <= 2^(c + 2)
+		unsigned long c = 0;
+		while ((static_cast<size_t>(4) << c) < 3 * k)
+			c++;
+		total += c;
+	}
+	return total;
+}
+
+// Every size up to maxN, a few random permutations each, must stay within
+// the Ford-Johnson bound
+static void benchBound(size_t maxN)
+{
+	PmergeMe sorter;
+	size_t failures = 0;
+
+	for (size_t n = 1; n <= maxN; n++)
+	{
+		unsigned long bound = fordJohnsonBound(n);
+		for (int r = 0; r < 10; r++)
+		{
+			std::vector<int> v(n);
+			for (size_t i = 0; i < n; i++)
+				v[i] = static_cast<int>(i);
+			std::random_shuffle(v.begin(), v.end());
+
+			unsigned long cmp = 0;
+			sorter.fordJohnsonSort(v, CountingCompare<std::less<int> >(std::less<int>(), &cmp));
+			if (cmp > bound || !isSorted(v, std::less<int>()))
+			{
+				if (failures++ < 5)
+					std::cout << RED "  n = " << n << ": " << cmp << " comparisons, bound " << bound << RESET << std::endl;
+			}
+		}
+	}
+	std::cout << BOLD << "Ford-Johnson bound, n = 1.." << maxN << ": " << RESET
+			  << (failures ? RED "FAILED" RESET : GREEN "ok" RESET) << std::endl;
+}
+
+// Speedup of the threaded sort, checked against the serial output and
+// comparison count
+static void benchThreads(size_t n)
+{
+	std::vector<Record> input(n);
+	for (size_t i = 0; i < n; i++)
+	{
+		input[i].name = randomKey();
+		input[i].name.resize(input[i].name.size() - 9); // plenty of equal keys
+		input[i].score = static_cast<int>(i);
+	}
+
+	// Only pairing and the chain rebuild run in parallel, the searches are
+	// serial: the speedup is bounded by that share and by the cores present
+	std::cout << BOLD << "threads, records with duplicate keys, n = " << n << RESET
+			  << " (parallel pairing and rebuild, serial searches, " << sysconf(_SC_NPROCESSORS_ONLN) << " core(s))"
+			  << std::endl;
+
+	std::vector<Record> reference;
+	unsigned long serialCmp = 0;
+	double serialUs = 0;
+	size_t threads[] = {1, 2, 4, 8, 16, 32};
+	for (size_t i = 0; i < sizeof(threads) / sizeof(threads[0]); i++)
+	{
+		PmergeMe sorter;
+		sorter.setThreads(threads[i]);
+		unsigned long cmp = 0;
+		std::vector<Record> v(input);
+		double t = monotonicUs();
+		sorter.fordJohnsonSort(v, CountingCompare<RecordLess>(RecordLess(), &cmp));
+		t = monotonicUs() - t;
+
+		bool same = true;
+		if (i == 0)
+		{
+			reference = v;
+			serialCmp = cmp;
+			serialUs = t;
+		}
+		for (size_t k = 0; k < n && same; k++)
+			same = (v[k].score == reference[k].score);
+
+		std::stringstream name;
+		name << threads[i] << " thread(s), x" << std::fixed << std::setprecision(2) << serialUs / t;
+		report(name.str(), n, cmp, t, same && isSorted(v, RecordLess()),
+			   cmp == serialCmp ? "" : RED "  COMPARISONS DIFFER" RESET);
+	}
+}
+
+static std::vector<int> makeInts(size_t n, const std::string &dist)
+{
+	std::vector<int> v(n);
+	for (size_t i = 0; i < n; i++)
+		v[i] = std::rand();
+	if (dist == "sorted" || dist == "nearly" || dist == "reversed")
+		std::sort(v.begin(), v.end());
+	if (dist == "reversed")
+		std::reverse(v.begin(), v.end());
+	if (dist == "nearly")
+		for (size_t i = 0; i < n / 100 + 1; i++)
+			std::swap(v[std::rand() % n], v[std::rand() % n]);
+	if (dist == "few-unique")
+		for (size_t i = 0; i < n; i++)
+			v[i] %= 16;
+	return v;
+}
+
+// ns per element of each engine over sizes and input shapes, the data behind
+// the thresholds in PmergeMe::chooseEngine
+static void benchEngines()
+{
+	const PmergeMe::Engine engines[] = {PmergeMe::ENGINE_MIN_COMPARISONS, PmergeMe::ENGINE_RADIX,
+										PmergeMe::ENGINE_NETWORK, PmergeMe::ENGINE_INTROSORT,
+										PmergeMe::ENGINE_AUTO};
+	const char *dists[] = {"random", "sorted", "reversed", "nearly", "few-unique"};
+	const size_t sizes[] = {8, 16, 64, 256, 1024, 16384, 262144};
+	const size_t nbEngines = sizeof(engines) / sizeof(engines[0]);
+
+	std::cout << BOLD << "engine matrix, ints, ns per element" << RESET << std::endl;
+	std::cout << std::left << std::setw(12) << "shape" << std::right << std::setw(8) << "n";
+	for (size_t e = 0; e < nbEngines; e++)
+		std::cout << std::setw(14) << PmergeMe::engineName(engines[e]);
+	std::cout << std::setw(14) << "std::sort" << std::endl;
+
+	for (size_t d = 0; d < sizeof(dists) / sizeof(dists[0]); d++)
+	{
+		for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++)
+		{
+			size_t n = sizes[s];
+			size_t reps = 1 + 1000000 / (n * 4);
+			std::vector<int> input = makeInts(n, dists[d]);
+			std::vector<int> expected(input);
+			std::sort(expected.begin(), expected.end());
+
+			std::cout << std::left << std::setw(12) << dists[d] << std::right << std::setw(8) << n;
+			for (size_t e = 0; e <= nbEngines; e++)
+			{
+				// Ford-Johnson moves O(n^2) elements, skip it on big inputs
+				if (e < nbEngines && engines[e] == PmergeMe::ENGINE_MIN_COMPARISONS && n > 16384)
+				{
+					std::cout << std::setw(14) << "-";
+					continue;
+				}
+				PmergeMe sorter;
+				if (e < nbEngines)
+					sorter.setEngine(engines[e]);
+				std::vector<int> v;
+				double total = 0;
+				for (size_t r = 0; r < reps; r++)
+				{
+					v = input;
+					double t = monotonicUs();
+					if (e < nbEngines)
+						sorter.hybridSort(v);
+					else
+						std::sort(v.begin(), v.end());
+					total += monotonicUs() - t;
+				}
+				std::stringstream cell;
+				cell << std::fixed << std::setprecision(1) << total * 1000.0 / (reps * n);
+				if (v != expected)
+					cell << "!";
+				std::cout << std::setw(14) << cell.str();
+			}
+			std::cout << std::endl;
+		}
+	}
+	std::cout << std::endl;
+}
+
+// An int that does not take the packed layout, to compare both layouts
+struct BoxedInt
+{
+	int v;
+	bool operator<(const BoxedInt &o) const { return v < o.v; }
+};
+
+template <typename T>
+static void layoutRow(const std::string &name, const T &input, PerfCounters &perf)
+{
+	PmergeMe sorter;
+	std::vector<double> us;
+	std::vector<double> misses;
+
+	for (int r = 0; r < 5; r++)
+	{
+		T c(input);
+		perf.start();
+		double t = monotonicUs();
+		sorter.fordJohnsonSort(c);
+		us.push_back(monotonicUs() - t);
+		perf.stop();
+		misses.push_back(static_cast<double>(perf.value(PerfCounters::CACHE_MISSES)) / input.size());
+	}
+
+	std::cout << std::left << std::setw(28) << name << std::right << std::setw(10) << input.size()
+			  << std::setw(14) << std::fixed << std::setprecision(0) << summarize(us).median << " us";
+	if (perf.available())
+		std::cout << std::setw(12) << std::setprecision(2) << summarize(misses).median << " misses/elem";
+	std::cout << std::endl;
+}
+
+// Packed (key, index) words against the index layout, median of 5 runs
+static void benchLayout(size_t n)
+{
+	PerfCounters perf;
+	std::vector<int> ints(n);
+	std::vector<BoxedInt> boxed(n);
+	for (size_t i = 0; i < n; i++)
+	{
+		ints[i] = std::rand();
+		boxed[i].v = ints[i];
+	}
+
+	std::cout << BOLD << "layout, Ford-Johnson on ints, n = " << n
+			  << (perf.available() ? "" : " (perf counters unavailable)") << RESET << std::endl;
+	layoutRow("packed (vector<int>)", ints, perf);
+	layoutRow("packed (deque<int>)", std::deque<int>(ints.begin(), ints.end()), perf);
+	layoutRow("indices (vector<BoxedInt>)", boxed, perf);
+	layoutRow("indices (deque<BoxedInt>)", std::deque<BoxedInt>(boxed.begin(), boxed.end()), perf);
+}
+
+int main(int ac, char **av)
+{
+	std::srand(42);
+	size_t sizes[] = {21, 1000, 10000};
+	size_t count = sizeof(sizes) / sizeof(sizes[0]);
+
+	if (ac > 1)
+	{
+		std::stringstream ss(av[1]);
+		if (!(ss >> sizes[0]))
+		{
+			std::cerr << "Error: usage: " << av[0] << " [n]" << std::endl;
+			return 1;
+		}
+		count = 1;
+	}
+
+	benchBound(400);
+	std::cout << std::endl;
+	std::cout << std::left << std::setw(28) << "algorithm" << std::right << std::setw(10) << "n"
+			  << std::setw(14) << "comparisons" << std::setw(17) << "time" << std::endl;
+	for (size_t i = 0; i < count; i++)
+	{
+		benchStrings(sizes[i]);
+		benchRecords(sizes[i]);
+		std::cout << std::endl;
+	}
+	for (size_t i = 0; i < count; i++)
+		benchLayout(sizes[i]);
+	std::cout << std::endl;
+	if (count > 1)
+		benchEngines();
+	benchThreads(count == 1 ? sizes[0] : 100000);
+	return 0;
+}
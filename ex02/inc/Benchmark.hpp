@@ -0,0 +1,71 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   Benchmark.hpp                                      :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: pol <pol@student.42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 16:10:03 by pol               #+#    #+#             */
+/*   Updated: 2026/10/19 16:10:03 by pol              ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef BENCHMARK_HPP
+#define BENCHMARK_HPP
+
+#include <vector>
+#include <cstddef>
+
+// Microseconds on CLOCK_MONOTONIC: nanosecond resolution, never adjusted
+double monotonicUs();
+
+// Calls to the global operator new made while counting was on
+unsigned long allocationCount();
+void countAllocations(bool on);
+
+// min / median / p99 of a set of samples
+struct Summary
+{
+	double min;
+	double median;
+	double p99;
+};
+
+Summary summarize(std::vector<double> samples);
+
+/**
+ * Hardware counters through perf_event_open (cycles, cache misses, branch
+ * misses) for the calling thread. When the kernel refuses (no permission,
+ * no PMU in a VM...), available() is false and every read gives 0.
+ */
+class PerfCounters
+{
+public:
+	enum Counter
+	{
+		CYCLES,
+		CACHE_MISSES,
+		BRANCH_MISSES,
+		NB_COUNTERS
+	};
+
+private:
+	int _fd[NB_COUNTERS];
+	unsigned long long _value[NB_COUNTERS];
+
+	// Owns perf descriptors
+	PerfCounters(const PerfCounters &src);
+	PerfCounters &operator=(const PerfCounters &src);
+
+public:
+	PerfCounters();
+	~PerfCounters();
+
+	bool available() const;
+	void start();
+	void stop();
+	unsigned long long value(Counter c) const;
+	static const char *name(Counter c);
+};
+
+#endif
@@ -0,0 +1,120 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   ExternalSort.hpp                                   :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: pol <pol@student.42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 14:48:37 by pol               #+#    #+#             */
+/*   Updated: 2026/10/19 14:48:37 by pol              ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef EXTERNALSORT_HPP
+#define EXTERNALSORT_HPP
+
+#include <vector>
+#include <string>
+#include <exception>
+#include <cstddef>
+
+class PmergeMe;
+
+/**
+ * Tournament tree of losers over k sorted runs: the winner (smallest head)
+ * sits in tree[0], and replacing it costs one comparison per level.
+ * Exhausted runs lose against everything.
+ */
+class LoserTree
+{
+private:
+	std::vector<size_t> _tree;
+	std::vector<int> _keys;
+	std::vector<bool> _done;
+
+	bool beats(size_t a, size_t b) const;
+
+public:
+	LoserTree();
+	LoserTree(const LoserTree &src);
+	LoserTree &operator=(const LoserTree &src);
+	~LoserTree();
+
+	// heads[i] is the first value of run i, done[i] if run i is empty
+	void build(const std::vector<int> &heads, const std::vector<bool> &done);
+	size_t winner() const;
+	int top() const;
+	bool empty() const;
+
+	// Replaces the winner's key with the next value of its run (or marks it done)
+	void replace(int key, bool done);
+};
+
+/**
+ * Out-of-core mode: the input is cut into runs that fit the memory budget,
+ * each run is sorted in memory (radix sort, or PmergeMe::hybridSort when
+ * another engine than Ford-Johnson is set) and spilled to an anonymous
+ * temporary file, then the runs are k-way merged through a loser
+ * tree with large sequential read and write buffers. When the budget cannot
+ * hold a buffer for every run, groups of runs are first merged into longer
+ * runs, so the budget holds for any input size.
+ */
+class ExternalSort
+{
+private:
+	PmergeMe *_sorter;
+	size_t _budget;
+
+	// Spilled runs: descriptor and number of ints in each
+	std::vector<int> _runFds;
+	std::vector<size_t> _runSizes;
+
+	// First values before and after sorting, for the Before/After lines
+	std::vector<int> _head;
+	std::vector<int> _sortedHead;
+
+	size_t _count;
+	size_t _runCount;
+	size_t _merges;
+	unsigned long _bytesRead;
+	unsigned long _bytesWritten;
+	double _runTime;
+	double _mergeTime;
+
+	int tempFile();
+	void spill(const std::vector<int> &run);
+	void sortRuns(const std::string &input, bool binary);
+	size_t fanIn() const;
+	void merge(int outFd, bool binary);
+	size_t mergeRuns(size_t k, int outFd, bool binary, bool intermediate);
+	void closeRuns();
+
+	// Owns temporary file descriptors
+	ExternalSort(const ExternalSort &src);
+	ExternalSort &operator=(const ExternalSort &src);
+
+public:
+	ExternalSort(PmergeMe &sorter, size_t budget);
+	~ExternalSort();
+
+	// Sorts input into output ("" to only merge, "-" for stdout), both in
+	// text or binary form
+	void run(const std::string &input, const std::string &output, bool binary);
+
+	size_t count() const;
+	size_t runCount() const;
+	size_t merges() const;
+	const std::vector<int> &head() const;
+	const std::vector<int> &sortedHead() const;
+	unsigned long bytesRead() const;
+	unsigned long bytesWritten() const;
+	double runTime() const;
+	double mergeTime() const;
+
+	class ErrorException : public std::exception
+	{
+		virtual const char *what() const throw() { return "Error"; }
+	};
+};
+
+#endif
@@ -0,0 +1,212 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   GroupChain.hpp                                     :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: pol <pol@student.42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 18:32:10 by pol               #+#    #+#             */
+/*   Updated: 2026/10/19 18:32:10 by pol              ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef GROUPCHAIN_HPP
+#define GROUPCHAIN_HPP
+
+#include <vector>
+#include <algorithm>
+#include <cstddef>
+#include "ParallelFor.hpp"
+
+// Below this many elements a group is inserted straight into the chain
+#define GROUP_BATCH_MIN 64
+
+// Where the placed elements of one gap live in the pool
+struct GapSlot
+{
+	size_t start;
+	size_t count;
+	size_t capacity;
+};
+
+/**
+ * The main chain while one Jacobsthal group is being inserted: the chain as
+ * it was before the group (the base) plus the group elements placed so far,
+ * kept per gap. Gap g holds what goes right before base[g]; gap base.size()
+ * is the end. Indexing gives the element the real chain would hold at that
+ * position, so a search probes exactly what the serial insertion would,
+ * without shifting the whole chain for every element.
+ *
+ * Block g is gap g followed by base[g]; a Fenwick tree over the block sizes
+ * maps a chain position to its block in O(log n). Every gap is a slot of one
+ * pool, moved to the end of the pool with twice the room when it fills up:
+ * the slots never take more than four times the group size, so the pool is
+ * allocated once per group.
+ */
+template <typename Seq>
+class GroupChain
+{
+public:
+	typedef typename Seq::value_type Item;
+
+private:
+	const Seq *_base;
+	std::vector<GapSlot> _gaps;
+	std::vector<size_t> _tree; // Fenwick tree (1-based) of the block sizes
+	std::vector<Item> _pool;
+	size_t _placed;
+	size_t _top; // highest power of two <= number of blocks
+
+	// Sum of the sizes of blocks [0, block]
+	size_t prefix(size_t block) const
+	{
+		size_t sum = 0;
+		for (size_t k = block + 1; k > 0; k -= k & (~k + 1))
+			sum += _tree[k];
+		return sum;
+	}
+
+	// Block holding chain position i, and the position inside that block
+	void locate(size_t i, size_t &block, size_t &offset) const
+	{
+		size_t pos = 0;
+		for (size_t step = _top; step > 0; step >>= 1)
+		{
+			if (pos + step < _tree.size() && _tree[pos + step] <= i)
+			{
+				pos += step;
+				i -= _tree[pos];
+			}
+		}
+		block = pos;
+		offset = i;
+	}
+
+	// Reuses one base, copying makes no sense
+	GroupChain(const GroupChain &src);
+	GroupChain &operator=(const GroupChain &src);
+
+public:
+	// groupSize: how many elements will be placed, to size the pool
+	GroupChain(const Seq &base, size_t groupSize)
+		: _base(&base), _tree(base.size() + 2, 0), _placed(0), _top(1)
+	{
+		GapSlot empty = {0, 0, 0};
+		_gaps.assign(base.size() + 1, empty);
+		_pool.reserve(4 * groupSize);
+
+		// Every block starts as its base element alone (the last one as a sentinel)
+		for (size_t k = 1; k < _tree.size(); k++)
+			_tree[k] = k & (~k + 1);
+		while (_top * 2 < _tree.size())
+			_top *= 2;
+	}
+
+	~GroupChain() {}
+
+	size_t size() const { return _base->size() + _placed; }
+
+	// Placed elements that sit before base[gap]
+	size_t placedBefore(size_t gap) const { return prefix(gap) - (gap + 1); }
+
+	const Item &operator[](size_t i) const
+	{
+		size_t block;
+		size_t offset;
+		locate(i, block, offset);
+		if (offset == _gaps[block].count)
+			return (*_base)[block];
+		return _pool[_gaps[block].start + offset];
+	}
+
+	// Probes exactly the positions searchLowerBound probes over [0, len)
+	template <typename Less>
+	size_t lowerBound(size_t len, const Item &val, const Less &less) const
+	{
+		size_t first = 0;
+		while (len > 0)
+		{
+			size_t half = len / 2;
+			bool right = less((*this)[first + half], val);
+			first += right ? half + 1 : 0;
+			len = right ? len - half - 1 : half;
+		}
+		return first;
+	}
+
+	// Inserts val at chain position pos
+	void place(size_t pos, const Item &val)
+	{
+		size_t block = _base->size();
+		size_t offset = _gaps[block].count;
+		if (pos < size())
+			locate(pos, block, offset);
+
+		GapSlot &gap = _gaps[block];
+		if (gap.count == gap.capacity)
+		{
+			// Full: move the gap to a slot twice as big at the end of the pool
+			size_t start = _pool.size();
+			_pool.resize(start + (gap.capacity ? 2 * gap.capacity : 2));
+			std::copy(_pool.begin() + gap.start, _pool.begin() + gap.start + gap.count, _pool.begin() + start);
+			gap.start = start;
+			gap.capacity = _pool.size() - start;
+		}
+		typename std::vector<Item>::iterator first = _pool.begin() + gap.start;
+		std::copy_backward(first + offset, first + gap.count, first + gap.count + 1);
+		first[offset] = val;
+		gap.count++;
+		_placed++;
+		for (size_t k = block + 1; k < _tree.size(); k += k & (~k + 1))
+			_tree[k]++;
+	}
+
+	// Writes the whole chain to out, each thread copying a range of blocks
+	void rebuild(Seq &out, size_t threads) const;
+};
+
+// parallelFor body for GroupChain::rebuild: copies blocks [begin, end)
+template <typename Seq>
+struct RebuildBody
+{
+	const Seq *base;
+	const std::vector<GapSlot> *gaps;
+	const std::vector<typename Seq::value_type> *pool;
+	std::vector<size_t> *starts;
+	Seq *out;
+
+	void operator()(size_t begin, size_t end)
+	{
+		size_t pos = (*starts)[begin];
+		for (size_t b = begin; b < end; b++)
+		{
+			const GapSlot &gap = (*gaps)[b];
+			for (size_t k = 0; k < gap.count; k++)
+				(*out)[pos++] = (*pool)[gap.start + k];
+			if (b < base->size())
+				(*out)[pos++] = (*base)[b];
+		}
+	}
+};
+
+template <typename Seq>
+void GroupChain<Seq>::rebuild(Seq &out, size_t threads) const
+{
+	size_t blocks = _gaps.size();
+
+	// Where each block starts in the rebuilt chain
+	std::vector<size_t> starts(blocks);
+	size_t pos = 0;
+	for (size_t b = 0; b < blocks; b++)
+	{
+		starts[b] = pos;
+		pos += _gaps[b].count + 1;
+	}
+
+	Seq chain(size());
+	RebuildBody<Seq> body = {_base, &_gaps, &_pool, &starts, &chain};
+	parallelFor(blocks, threads, body);
+	out.swap(chain);
+}
+
+#endif
@@ -0,0 +1,77 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   InputReader.hpp                                    :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: pol <pol@student.42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 14:05:12 by pol               #+#    #+#             */
+/*   Updated: 2026/10/19 14:05:12 by pol              ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef INPUTREADER_HPP
+#define INPUTREADER_HPP
+
+#include <vector>
+#include <string>
+#include <exception>
+#include <cstddef>
+
+// Reads one positive int starting at p, leaves p on the byte after it
+bool scanNumber(const char *&p, const char *end, int &out);
+
+/**
+ * Streams positive ints out of a file ("-" for stdin), either whitespace
+ * separated text or raw little-endian int32. Regular files are mapped;
+ * pipes are read in blocks, so the input never has to fit in memory at once.
+ * Under a buffer limit, regular files are read in blocks too.
+ */
+class InputReader
+{
+private:
+	int _fd;
+	bool _binary;
+	bool _eof;
+
+	// Bytes not consumed yet: the whole mapping, or the block buffer
+	const char *_map;
+	size_t _mapLen;
+	std::vector<char> _buf;
+	const char *_pos;
+	const char *_end;
+
+	unsigned long _bytesRead;
+	size_t _bufferLimit; // 0 = no limit
+
+	bool refill();
+	void close();
+
+	// Owns a descriptor and a mapping, copying makes no sense
+	InputReader(const InputReader &src);
+	InputReader &operator=(const InputReader &src);
+
+public:
+	InputReader();
+	~InputReader();
+
+	void open(const std::string &path, bool binary);
+
+	// Holds at most about bytes of input at a time (0 = no limit, the
+	// default), for callers with a memory budget. Applies from the next open.
+	void setBufferLimit(size_t bytes);
+
+	// Appends up to max numbers to out, returns how many were read
+	size_t read(std::vector<int> &out, size_t max);
+
+	// Expected number count, 0 when unknown (pipes)
+	size_t sizeHint() const;
+	unsigned long bytesRead() const;
+
+	class ErrorException : public std::exception
+	{
+		virtual const char *what() const throw() { return "Error"; }
+	};
+};
+
+#endif
@@ -0,0 +1,79 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   ParallelFor.hpp                                    :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: pol <pol@student.42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 10:02:11 by pol               #+#    #+#             */
+/*   Updated: 2026/10/19 10:02:11 by pol              ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef PARALLELFOR_HPP
+#define PARALLELFOR_HPP
+
+#include <vector>
+#include <cstddef>
+#include <pthread.h>
+
+// Below this many items per thread, spawning threads costs more than it saves
+#define PARALLEL_GRAIN 4096
+
+// One slice of a parallelFor, run on its own pthread
+template <typename Body>
+struct ParallelJob
+{
+	Body *body;
+	size_t begin;
+	size_t end;
+	pthread_t tid;
+	bool started;
+
+	static void *run(void *arg)
+	{
+		ParallelJob *job = static_cast<ParallelJob *>(arg);
+		(*job->body)(job->begin, job->end);
+		return NULL;
+	}
+};
+
+/**
+ * Fork-join over [0, n): calls body(begin, end) on disjoint slices, the
+ * first slice on the calling thread. Returns once every slice is done.
+ * If a thread cannot be created its slice simply runs on the caller.
+ */
+template <typename Body>
+void parallelFor(size_t n, size_t threads, Body &body)
+{
+	if (threads > n / PARALLEL_GRAIN)
+		threads = n / PARALLEL_GRAIN;
+	if (threads <= 1)
+	{
+		body(0, n);
+		return;
+	}
+
+	size_t chunk = (n + threads - 1) / threads;
+	std::vector<ParallelJob<Body> > jobs(threads);
+	for (size_t t = 0; t < threads; t++)
+	{
+		jobs[t].body = &body;
+		jobs[t].begin = t * chunk;
+		jobs[t].end = (t * chunk + chunk < n) ? t * chunk + chunk : n;
+		jobs[t].started = false;
+	}
+	for (size_t t = 1; t < threads; t++)
+		jobs[t].started = (pthread_create(&jobs[t].tid, NULL, &ParallelJob<Body>::run, &jobs[t]) == 0);
+
+	body(jobs[0].begin, jobs[0].end);
+	for (size_t t = 1; t < threads; t++)
+	{
+		if (jobs[t].started)
+			pthread_join(jobs[t].tid, NULL);
+		else
+			body(jobs[t].begin, jobs[t].end);
+	}
+}
+
+#endif
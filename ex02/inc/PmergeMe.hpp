@@ -19,9 +19,14 @@
 #include <string>
 #include <algorithm>
 #include <ctime>
-#include <sys/time.h>
 #include <iomanip>
-// #include <typeinfo> //debug
+#include <functional>
+#include <cstddef>
+#include <stdint.h>
+#include "ParallelFor.hpp"
+#include "GroupChain.hpp"
+#include "SortEngines.hpp"
+#include "Benchmark.hpp"
 
 #define RESET "\033[0m"
 #define RED "\033[31m"
@@ -32,8 +37,143 @@
 #define CYAN "\033[36m"
 #define BOLD "\033[1m"
 
+/**
+ * Packed layout for int keys: the key (sign bit flipped, so unsigned order
+ * matches int order) in the high half, its index in the low half. Items carry
+ * their key, so comparisons never leave the working arrays.
+ */
+struct PackedKey
+{
+	uint64_t bits;
+
+	static PackedKey make(int key, size_t index)
+	{
+		PackedKey p;
+		p.bits = (static_cast<uint64_t>(static_cast<uint32_t>(key) ^ 0x80000000u) << 32) | index;
+		return p;
+	}
+	int key() const { return static_cast<int>(static_cast<uint32_t>(bits >> 32) ^ 0x80000000u); }
+	bool operator==(const PackedKey &o) const { return bits == o.bits; }
+	bool operator!=(const PackedKey &o) const { return bits != o.bits; }
+};
+
+// Position of an item in the caller's container, whatever the layout
+inline size_t itemIndex(size_t item) { return item; }
+inline size_t itemIndex(const PackedKey &item) { return item.bits & 0xFFFFFFFFu; }
+
+// Only int keys take the packed layout
+template <typename V>
+struct Packable
+{
+	static const bool value = false;
+};
+
+template <>
+struct Packable<int>
+{
+	static const bool value = true;
+};
+
+// Compares packed items on their keys with the user comparator
+template <typename Compare>
+struct PackedLess
+{
+	Compare comp;
+
+	PackedLess(Compare c) : comp(c) {}
+	bool operator()(const PackedKey &a, const PackedKey &b) const { return comp(a.key(), b.key()); }
+};
+
+// With std::less<int> that is a single compare of the high halves
+template <>
+struct PackedLess<std::less<int> >
+{
+	PackedLess(std::less<int>) {}
+	bool operator()(const PackedKey &a, const PackedKey &b) const { return (a.bits >> 32) < (b.bits >> 32); }
+};
+
+// Compares through pointers, used to keep deque elements off the chunk map
+template <typename Compare>
+struct DerefCompare
+{
+	Compare comp;
+
+	DerefCompare(Compare c) : comp(c) {}
+	template <typename V>
+	bool operator()(const V *a, const V *b) const { return comp(*a, *b); }
+};
+
+// Compares the elements behind two indices with the user comparator
+template <typename C, typename Compare>
+struct IndexLess
+{
+	const C *values;
+	Compare comp;
+
+	IndexLess(const C &v, Compare c) : values(&v), comp(c) {}
+	bool operator()(size_t a, size_t b) const { return comp((*values)[a], (*values)[b]); }
+};
+
+// Wraps a comparator and counts every call, used to report comparison counts.
+// The counter is bumped atomically so it stays exact under setThreads().
+template <typename Compare>
+struct CountingCompare
+{
+	Compare comp;
+	unsigned long *count;
+
+	CountingCompare(Compare c, unsigned long *n) : comp(c), count(n) {}
+	template <typename V>
+	bool operator()(const V &a, const V &b) const
+	{
+		__sync_fetch_and_add(count, 1UL);
+		return comp(a, b);
+	}
+};
+
+// Counting comparisons must not change which engine runs
+template <>
+struct Radixable<int, CountingCompare<std::less<int> > >
+{
+	static const bool value = true;
+};
+
+// parallelFor body for step 2: forms pairs [begin, end) independently
+template <typename Seq, typename Less>
+struct PairBody
+{
+	const Seq *items;
+	const Less *less;
+	std::vector<typename Seq::value_type> *winner;
+	std::vector<typename Seq::value_type> *loser;
+
+	void operator()(size_t begin, size_t end)
+	{
+		for (size_t k = begin; k < end; k++)
+		{
+			typename Seq::value_type a = (*items)[2 * k];
+			typename Seq::value_type b = (*items)[2 * k + 1];
+			if ((*less)(a, b))
+				std::swap(a, b);
+			(*winner)[k] = a;
+			(*loser)[k] = b;
+		}
+	}
+};
+
 class PmergeMe
 {
+public:
+	// Engines hybridSort can run. MIN_COMPARISONS always means Ford-Johnson.
+	enum Engine
+	{
+		ENGINE_AUTO,
+		ENGINE_MIN_COMPARISONS,
+		ENGINE_RADIX,
+		ENGINE_NETWORK,
+		ENGINE_INTROSORT
+	};
+
 private:
 	// Containers for the two required implementations
 	// Fast index-based access and contiguous memory, ideal for the primary sorting steps.
@@ -46,9 +186,53 @@ private:
 	double _vecTime;
 	double _deqTime;
 
+	// Worker threads used by fordJohnsonSort (1 = serial)
+	size_t _threads;
+
+	// Engine used by hybridSort, and whether comparisons are expensive
+	Engine _engine;
+	bool _costlyCompare;
+
+	// Bulk input file ("-" for stdin), text or raw little-endian int32
+	std::string _inputPath;
+	bool _inputBinary;
+
+	// Out-of-core mode: memory budget in bytes (0 = off) and output file
+	size_t _memoryBudget;
+	std::string _outputPath;
+
+	// Benchmark mode: timed trials per container (0 = single run)
+	size_t _iterations;
+
+	void executeExternal();
+	void executeBenchmark();
+
 	// Internal tools for the Ford-Johnson algorithm
-	std::vector<int> generateJacobsthal(int n);
-	std::vector<int> buildInsertionOrder(int size);
+	std::vector<size_t> generateJacobsthal(size_t n);
+	std::vector<size_t> buildInsertionOrder(size_t size);
+
+	template <typename T, typename Compare>
+	void fordJohnsonLayout(T &container, Compare comp, BoolTag<false>);
+	template <typename T, typename Compare>
+	void fordJohnsonLayout(T &container, Compare comp, BoolTag<true>);
+	template <typename C, typename Compare>
+	void fordJohnsonOrder(const C &values, Compare comp, std::vector<size_t> &order);
+	template <typename V, typename A, typename Compare>
+	void fordJohnsonOrder(const std::deque<V, A> &values, Compare comp, std::vector<size_t> &order);
+	template <typename Seq, typename Less>
+	void mergeInsert(Seq &items, const Less &less, std::vector<size_t> &slot);
+	template <typename Seq, typename Less>
+	void insertGroup(Seq &mainChain, const Seq &winners, const Seq &pend, const size_t *group,
+					 size_t count, size_t inserted, const Less &less);
+	template <typename T, typename Seq>
+	static void applyOrder(T &container, const Seq &order);
+
+	template <typename T, typename Compare>
+	Engine chooseEngine(const T &container, Compare comp) const;
+	template <typename T>
+	static void runRadix(T &container, BoolTag<true>);
+	template <typename T>
+	static void runRadix(T &container, BoolTag<false>);
 
 public:
 	// Canonical Form
@@ -60,12 +244,41 @@ public:
 	// Main execution flow
 	void execute(int ac, char **av);
 
-	// Template function to handle both vector and deque with the same logic
+	// Template functions to handle both vector and deque with the same logic.
+	// Any element type works given a strict weak ordering; the key variant
+	// takes a std::unary_function style projection and compares its results.
 	template <typename T>
 	void fordJohnsonSort(T &container);
+	template <typename T, typename Compare>
+	void fordJohnsonSort(T &container, Compare comp);
+	template <typename T, typename KeyFn>
+	void fordJohnsonSortByKey(T &container, KeyFn key);
+
+	// Multi-threaded sorting. The comparator must be safe to call concurrently.
+	// Pairing and the chain rebuild of large groups run in parallel, the
+	// binary searches stay serial: the output and the comparison count are
+	// identical whatever the thread count.
+	void setThreads(size_t threads);
+	size_t getThreads() const;
+
+	// Hybrid engine: Ford-Johnson, radix, sorting network or introsort,
+	// picked from the size, presortedness and comparison cost of the input
+	template <typename T>
+	void hybridSort(T &container);
+	template <typename T, typename Compare>
+	void hybridSort(T &container, Compare comp);
+	void setEngine(Engine engine);
+	Engine getEngine() const;
+	void setCostlyCompare(bool costly);
+	static const char *engineName(Engine engine);
 
 	// Parsing and validation
 	void parseInput(int ac, char **av);
+	void parseFile(const std::string &path, bool binary);
+	void setInputFile(const std::string &path, bool binary);
+	void setMemoryBudget(size_t bytes);
+	void setOutputFile(const std::string &path);
+	void setIterations(size_t iterations);
 
 	// Custom exception for error handling
 	class ErrorException : public std::exception
@@ -76,128 +289,354 @@ public:
 
 /**
  * FORD-JOHNSON ALGORITHM (Template Implementation)
+ *
+ * The recursion works on indices into the caller's container, so elements are
+ * never copied while sorting and equal values never get confused with each
+ * other. The resulting order is applied at the end with swaps only.
+ * Int keys use the packed layout instead: every item is a (key, index) word,
+ * so the working arrays are all that the comparisons ever touch.
+ * Either way the working arrays are vectors, also for a deque: the deque is
+ * only walked sequentially or through a pointer table, never via its chunk map
+ * in the hot loops.
  */
+template <typename T, typename Compare>
+void PmergeMe::fordJohnsonSort(T &container, Compare comp)
+{
+	if (container.size() <= 1)
+		return;
+
+	fordJohnsonLayout(container, comp, BoolTag<Packable<typename T::value_type>::value>());
+}
+
+template <typename T, typename Compare>
+void PmergeMe::fordJohnsonLayout(T &container, Compare comp, BoolTag<false>)
+{
+	std::vector<size_t> order;
+	fordJohnsonOrder(container, comp, order);
+	applyOrder(container, order);
+}
+
+template <typename T, typename Compare>
+void PmergeMe::fordJohnsonLayout(T &container, Compare comp, BoolTag<true>)
+{
+	size_t n = container.size();
+	if (n > 0xFFFFFFFFu)
+	{
+		fordJohnsonLayout(container, comp, BoolTag<false>());
+		return;
+	}
+
+	std::vector<PackedKey> items;
+	items.reserve(n);
+	size_t i = 0;
+	for (typename T::iterator it = container.begin(); it != container.end(); ++it)
+		items.push_back(PackedKey::make(*it, i++));
+
+	std::vector<size_t> slot(n);
+	mergeInsert(items, PackedLess<Compare>(comp), slot);
+
+	i = 0;
+	for (typename T::iterator it = container.begin(); it != container.end(); ++it)
+		*it = items[i++].key();
+}
+
 template <typename T>
 void PmergeMe::fordJohnsonSort(T &container)
 {
+	fordJohnsonSort(container, std::less<typename T::value_type>());
+}
+
+// Each key is projected once up front, then only the keys are compared
+template <typename T, typename KeyFn>
+void PmergeMe::fordJohnsonSortByKey(T &container, KeyFn key)
+{
+	typedef typename KeyFn::result_type Key;
+
 	if (container.size() <= 1)
 		return;
 
-	// Bool created for vector
-	// bool isVector = (typeid(container) == typeid(std::vector<int>)); //[DEBUG]
+	std::vector<Key> keys;
+	keys.reserve(container.size());
+	for (typename T::iterator it = container.begin(); it != container.end(); ++it)
+		keys.push_back(key(*it));
 
-	// if (isVector) //[DEBUG]
-	// std::cout << BOLD << "[DEBUG] Starting Ford-Johnson on " << container.size() << " elements." << RESET << std::endl;
+	std::vector<size_t> order;
+	fordJohnsonOrder(keys, std::less<Key>(), order);
+	applyOrder(container, order);
+}
+
+template <typename C, typename Compare>
+void PmergeMe::fordJohnsonOrder(const C &values, Compare comp, std::vector<size_t> &order)
+{
+	order.clear();
+	for (size_t i = 0; i < values.size(); i++)
+		order.push_back(i);
+
+	std::vector<size_t> slot(values.size());
+	mergeInsert(order, IndexLess<C, Compare>(values, comp), slot);
+}
+
+// Deque elements are reached through a pointer table built in one sequential pass
+template <typename V, typename A, typename Compare>
+void PmergeMe::fordJohnsonOrder(const std::deque<V, A> &values, Compare comp, std::vector<size_t> &order)
+{
+	std::vector<const V *> ptrs;
+	ptrs.reserve(values.size());
+	for (typename std::deque<V, A>::const_iterator it = values.begin(); it != values.end(); ++it)
+		ptrs.push_back(&*it);
+	fordJohnsonOrder(ptrs, DerefCompare<Compare>(comp), order);
+}
+
+/**
+ * Sorts a vector of items (plain indices or packed keys). Winners, losers
+ * and pend are separate contiguous arrays; `slot` is scratch space shared by
+ * every level of the recursion that maps a winner's index back to its pair.
+ */
+template <typename Seq, typename Less>
+void PmergeMe::mergeInsert(Seq &items, const Less &less, std::vector<size_t> &slot)
+{
+	typedef typename Seq::value_type Item;
+
+	if (items.size() <= 1)
+		return;
 
 	// 1. Straggler handling
-	bool hasStraggler = (container.size() % 2 != 0);
-	int straggler = 0;
+	bool hasStraggler = (items.size() % 2 != 0);
+	Item straggler = Item();
 	if (hasStraggler)
 	{
-		straggler = container.back();
-		container.pop_back();
-		// if (isVector) //[DEBUG]
-		// std::cout << MAGENTA << "[DEBUG] Straggler identified: " << straggler << RESET << std::endl;
+		straggler = items.back();
+		items.pop_back();
 	}
 
-	// 2. Pair creation
-	typedef std::pair<int, int> IntPair;
-	std::vector<IntPair> pairs;
-	for (size_t i = 0; i < container.size(); i += 2)
-	{
-		if (container[i] < container[i + 1])
-			pairs.push_back(std::make_pair(container[i + 1], container[i]));
-		else
-			pairs.push_back(std::make_pair(container[i], container[i + 1]));
-	}
-
-	// if (isVector) //[DEBUG]
-	//{			  //[DEBUG]
-	// std::cout << CYAN << "[DEBUG] Pairs formed (Winner first): " << RESET;
-	// for (size_t i = 0; i < pairs.size(); ++i)								  //[DEBUG]
-	// std::cout << "(" << pairs[i].first << "," << pairs[i].second << ") "; //[DEBUG]
-	// std::cout << std::endl;													  //[DEBUG]
-	//} //[DEBUG]
+	// 2. Pair creation (winner is the larger element of each pair)
+	size_t nbPairs = items.size() / 2;
+	Seq pairWinner(nbPairs);
+	Seq pairLoser(nbPairs);
+	PairBody<Seq, Less> pairBody = {&items, &less, &pairWinner, &pairLoser};
+	parallelFor(nbPairs, _threads, pairBody);
+	Seq winners(pairWinner);
 
 	// 3. Recursive Sort
-	T winners;
-	for (size_t i = 0; i < pairs.size(); i++)
-		winners.push_back(pairs[i].first);
+	mergeInsert(winners, less, slot);
 
-	fordJohnsonSort(winners);
+	// Deeper levels reuse `slot` for their own pairs, so fill it afterwards
+	for (size_t k = 0; k < nbPairs; k++)
+		slot[itemIndex(pairWinner[k])] = k;
 
 	// 4. Reconstruction
-	T mainChain;
-	T pend;
-	for (typename T::iterator it = winners.begin(); it != winners.end(); ++it)
+	Seq mainChain;
+	Seq pend;
+	mainChain.reserve(items.size() + 1);
+	pend.reserve(nbPairs + 1);
+	for (typename Seq::iterator it = winners.begin(); it != winners.end(); ++it)
+	{
+		mainChain.push_back(*it);
+		pend.push_back(pairLoser[slot[itemIndex(*it)]]);
+	}
+
+	// The straggler is the last pend element, one without a winner: it is
+	// inserted with its Jacobsthal group and searched over the whole chain
+	if (hasStraggler)
+		pend.push_back(straggler);
+
+	// 5. Initial insertion: pend[0] is smaller than every winner, no comparison needed
+	mainChain.insert(mainChain.begin(), pend[0]);
+
+	// 6. Jacobsthal Insertion
+	// pend[idx] only has to be searched for before its own winner. Winners keep
+	// their relative order, so that winner sits at most `idx + 1 + inserted`
+	// positions in; the few elements of the current group that landed behind it
+	// are skipped by walking back until the index matches.
+	if (pend.size() > 1)
 	{
-		int winner = *it;
-		mainChain.push_back(winner);
-		for (size_t i = 0; i < pairs.size(); i++)
+		std::vector<size_t> insertionOrder = buildInsertionOrder(pend.size());
+		size_t inserted = 0;
+		size_t i = 0;
+		while (i < insertionOrder.size())
 		{
-			if (pairs[i].first == winner)
+			// A Jacobsthal group is a descending run of the insertion order
+			size_t end = i + 1;
+			while (end < insertionOrder.size() && insertionOrder[end] < insertionOrder[end - 1])
+				end++;
+
+			if (end - i >= GROUP_BATCH_MIN)
 			{
-				pend.push_back(pairs[i].second);
-				pairs[i].first = -1;
-				break;
+				insertGroup(mainChain, winners, pend, &insertionOrder[i], end - i, inserted, less);
+				inserted += end - i;
+				i = end;
+				continue;
+			}
+			for (; i < end; ++i)
+			{
+				size_t idx = insertionOrder[i];
+				size_t bound = mainChain.size();
+				if (idx < nbPairs)
+				{
+					bound = idx + 1 + inserted;
+					while (mainChain[bound] != winners[idx])
+						--bound;
+				}
+				Item val = pend[idx];
+				mainChain.insert(searchLowerBound(mainChain.begin(), bound, val, less), val);
+				inserted++;
 			}
 		}
 	}
 
-	// if (isVector) //[DEBUG]
-	//{			  //[DEBUG]
-	// std::cout << BLUE << "[DEBUG] Main Chain (winners sorted): " << RESET;
-	// for (size_t i = 0; i < mainChain.size(); ++i) //[DEBUG]
-	// std::cout << mainChain[i] << " ";		  //[DEBUG]
-	// std::cout << YELLOW << "\n[DEBUG] Pend (losers): " << RESET;
-	// for (size_t i = 0; i < pend.size(); ++i) //[DEBUG]
-	// std::cout << pend[i] << " ";		 //[DEBUG]
-	// std::cout << std::endl;					 //[DEBUG]
-	//} //[DEBUG]
-
-	// 5. Initial insertion
-	if (!pend.empty())
+	items.swap(mainChain);
+}
+
+/**
+ * Inserts one Jacobsthal group in a batch. Each element is searched in the
+ * insertion order, over a GroupChain that holds the elements already placed,
+ * so it probes the very elements a shift-per-element insertion would: the
+ * comparison count and the result are the same. The searches stay serial, as
+ * the landing spots of the previous ones decide each range; only the chain
+ * rebuild, done once per group, is shared between the threads.
+ */
+template <typename Seq, typename Less>
+void PmergeMe::insertGroup(Seq &mainChain, const Seq &winners, const Seq &pend, const size_t *group,
+						   size_t count, size_t inserted, const Less &less)
+{
+	GroupChain<Seq> chain(mainChain, count);
+
+	for (size_t i = 0; i < count; i++)
 	{
-		mainChain.insert(mainChain.begin(), pend[0]);
-		// if (isVector) //[DEBUG]
-		// std::cout << GREEN << "[DEBUG] First pend element " << pend[0] << " inserted at start." << RESET << std::endl;
+		size_t idx = group[i];
+		typename Seq::value_type val = pend[idx];
+		size_t pos;
+
+		if (idx < winners.size())
+		{
+			// Earlier groups all landed before this winner, so it sits exactly
+			// here in the base; group elements placed before it extend the range
+			size_t winner = idx + 1 + inserted;
+			size_t before = chain.placedBefore(winner);
+			if (before == 0)
+				pos = searchLowerBound(mainChain.begin(), winner, val, less) - mainChain.begin();
+			else
+				pos = chain.lowerBound(winner + before, val, less);
+		}
+		else
+			pos = chain.lowerBound(chain.size(), val, less);
+		chain.place(pos, val);
 	}
+	chain.rebuild(mainChain, _threads);
+}
 
-	// 6. Jacobsthal Insertion
-	if (pend.size() > 1)
+/**
+ * Moves container[order[i]] to position i by following the permutation
+ * cycles, so every element is swapped into place instead of copied.
+ */
+template <typename T, typename Seq>
+void PmergeMe::applyOrder(T &container, const Seq &order)
+{
+	using std::swap;
+	std::vector<bool> done(order.size(), false);
+
+	for (size_t i = 0; i < order.size(); i++)
 	{
-		std::vector<int> insertionOrder = buildInsertionOrder(pend.size());
-		// if (isVector) //[DEBUG]
-		//{			  //[DEBUG]
-		// std::cout << BOLD << "[DEBUG] Jacobsthal insertion order (indices): " << RESET;
-		// for (size_t i = 0; i < insertionOrder.size(); ++i) //[DEBUG]
-		// std::cout << insertionOrder[i] << " ";		   //[DEBUG]
-		// std::cout << std::endl;							   //[DEBUG]
-		//} //[DEBUG]
-
-		for (size_t i = 0; i < insertionOrder.size(); ++i)
+		size_t cur = i;
+		while (!done[cur])
 		{
-			int idx = insertionOrder[i];
-			if (idx <= 0 || idx >= (int)pend.size())
-				continue;
-			int val = pend[idx];
-			typename T::iterator it = std::lower_bound(mainChain.begin(), mainChain.end(), val);
-			mainChain.insert(it, val);
-			// if (isVector) //[DEBUG]
-			// std::cout << GREEN << "[DEBUG] Inserting pend[" << idx << "] (" << val << ") using binary search." << RESET << std::endl;
+			done[cur] = true;
+			size_t src = order[cur];
+			if (src == i)
+				break;
+			swap(container[cur], container[src]);
+			cur = src;
 		}
 	}
+}
 
-	// 7. Final Straggler
-	if (hasStraggler)
+/**
+ * HYBRID ENGINE DISPATCH
+ *
+ * Thresholds come from the engine matrix printed by `make bench`.
+ */
+template <typename T>
+void PmergeMe::hybridSort(T &container)
+{
+	hybridSort(container, std::less<typename T::value_type>());
+}
+
+template <typename T, typename Compare>
+void PmergeMe::hybridSort(T &container, Compare comp)
+{
+	typedef typename T::value_type V;
+
+	if (container.size() <= 1)
+		return;
+
+	switch (chooseEngine(container, comp))
+	{
+	case ENGINE_MIN_COMPARISONS:
+		fordJohnsonSort(container, comp);
+		break;
+	case ENGINE_RADIX:
+		runRadix(container, BoolTag<Radixable<V, Compare>::value>());
+		break;
+	case ENGINE_NETWORK:
+		smallSort(container.begin(), container.end(), comp, BoolTag<Radixable<V, Compare>::value>());
+		break;
+	default:
+		introSort(container.begin(), container.end(), comp);
+		break;
+	}
+}
+
+template <typename T, typename Compare>
+PmergeMe::Engine PmergeMe::chooseEngine(const T &container, Compare comp) const
+{
+	typedef typename T::value_type V;
+	bool radixable = Radixable<V, Compare>::value;
+	size_t n = container.size();
+
+	if (_engine == ENGINE_RADIX)
+		return radixable ? _engine : ENGINE_INTROSORT;
+	// Bigger inputs still get the network, on introsort's leaves
+	if (_engine == ENGINE_NETWORK)
+		return (radixable && n <= NETWORK_SIZE) ? _engine : ENGINE_INTROSORT;
+	if (_engine != ENGINE_AUTO)
+		return _engine;
+
+	// Every comparison counts: Ford-Johnson needs the fewest
+	if (_costlyCompare)
+		return ENGINE_MIN_COMPARISONS;
+	if (n <= NETWORK_SIZE)
+		return radixable ? ENGINE_NETWORK : ENGINE_INTROSORT;
+	if (!radixable || n < RADIX_MIN)
+		return ENGINE_INTROSORT;
+
+	// Introsort finishes (nearly) sorted or reversed input in close to one
+	// linear pass, radix always pays its four passes. Sample the ascents and
+	// the descents: when either is rare the input is mostly one run.
+	size_t step = (n > 4096) ? n / 4096 : 1;
+	size_t ascents = 0;
+	size_t descents = 0;
+	size_t samples = 0;
+	for (size_t i = step; i < n; i += step)
 	{
-		typename T::iterator it = std::lower_bound(mainChain.begin(), mainChain.end(), straggler);
-		mainChain.insert(it, straggler);
-		// if (isVector) //[DEBUG]
-		// std::cout << MAGENTA << "[DEBUG] Final straggler " << straggler << " inserted." << RESET << std::endl;
+		ascents += comp(container[i - 1], container[i]);
+		descents += comp(container[i], container[i - 1]);
+		samples++;
 	}
+	if (std::min(ascents, descents) * 16 <= samples)
+		return ENGINE_INTROSORT;
+	return ENGINE_RADIX;
+}
+
+template <typename T>
+void PmergeMe::runRadix(T &container, BoolTag<true>)
+{
+	radixSort(container);
+}
 
-	container = mainChain;
+template <typename T>
+void PmergeMe::runRadix(T &container, BoolTag<false>)
+{
+	introSort(container.begin(), container.end(), std::less<typename T::value_type>());
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,325 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   SortEngines.hpp                                    :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: pol <pol@student.42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 11:20:45 by pol               #+#    #+#             */
+/*   Updated: 2026/10/19 11:20:45 by pol              ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef SORTENGINES_HPP
+#define SORTENGINES_HPP
+
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <cstddef>
+
+/**
+ * Sort engines used by PmergeMe::hybridSort next to Ford-Johnson.
+ * They work on random access iterators, so vector and deque are both fine.
+ */
+
+// Blocks up to this size go through the fixed sorting network
+#define NETWORK_SIZE 16
+
+// Introsort hands partitions up to this size to the small-block sort
+#define INTRO_SMALL 24
+
+// Below this size introsort beats radix sort on random ints (engine matrix, -O2)
+#define RADIX_MIN 1024
+
+// Radix sort only applies to int keys in ascending order
+template <typename V, typename Compare>
+struct Radixable
+{
+	static const bool value = false;
+};
+
+template <>
+struct Radixable<int, std::less<int> >
+{
+	static const bool value = true;
+};
+
+template <bool B>
+struct BoolTag
+{
+};
+
+/**
+ * Comparator pairs of Batcher's odd-even merge network for NETWORK_SIZE
+ * inputs, built once at start-up (see SortEngines.cpp).
+ */
+struct SortNetwork
+{
+	size_t size;
+	unsigned char a[128];
+	unsigned char b[128];
+};
+
+const SortNetwork &sortNetwork();
+
+/**
+ * Sorts up to NETWORK_SIZE ints. Every compare-exchange is a branchless
+ * min/max that puts the minimum on the lower lane, so lanes past the block
+ * would only ever hold padding and the exchanges reaching them are skipped.
+ * The others go through comp (an int ordering equivalent to std::less), so
+ * counting wrappers see one comparison per exchange between real elements.
+ */
+template <typename It, typename Compare>
+void networkSort(It first, It last, Compare comp)
+{
+	const SortNetwork &net = sortNetwork();
+	size_t n = last - first;
+	int v[NETWORK_SIZE];
+
+	for (size_t i = 0; i < n; i++)
+		v[i] = first[i];
+	for (size_t k = 0; k < net.size; k++)
+	{
+		if (net.b[k] >= n)
+			continue;
+		int x = v[net.a[k]];
+		int y = v[net.b[k]];
+		bool swap = comp(y, x);
+		v[net.a[k]] = swap ? y : x;
+		v[net.b[k]] = swap ? x : y;
+	}
+	for (size_t i = 0; i < n; i++)
+		first[i] = v[i];
+}
+
+template <typename It, typename Compare>
+void insertionSort(It first, It last, Compare comp)
+{
+	typedef typename std::iterator_traits<It>::value_type V;
+
+	if (first == last)
+		return;
+	for (It i = first + 1; i != last; ++i)
+	{
+		if (!comp(*i, *(i - 1)))
+			continue;
+		V tmp = *i;
+		It j = i;
+		do
+		{
+			*j = *(j - 1);
+			--j;
+		} while (j != first && comp(tmp, *(j - 1)));
+		*j = tmp;
+	}
+}
+
+// Small blocks: the network for plain ints, insertion sort for the rest
+template <typename It, typename Compare>
+void smallSort(It first, It last, Compare comp, BoolTag<false>)
+{
+	insertionSort(first, last, comp);
+}
+
+template <typename It, typename Compare>
+void smallSort(It first, It last, Compare comp, BoolTag<true>)
+{
+	if (last - first <= NETWORK_SIZE)
+		networkSort(first, last, comp);
+	else
+		insertionSort(first, last, comp);
+}
+
+/**
+ * Insertion sort that gives up after a few moves. Used when a partition did
+ * not swap anything, which on already sorted input finishes the job in a
+ * single linear pass.
+ */
+template <typename It, typename Compare>
+bool partialInsertionSort(It first, It last, Compare comp)
+{
+	typedef typename std::iterator_traits<It>::value_type V;
+	size_t moves = 0;
+
+	if (first == last)
+		return true;
+	for (It i = first + 1; i != last; ++i)
+	{
+		if (!comp(*i, *(i - 1)))
+			continue;
+		V tmp = *i;
+		It j = i;
+		do
+		{
+			*j = *(j - 1);
+			--j;
+		} while (j != first && comp(tmp, *(j - 1)));
+		*j = tmp;
+		moves += i - j;
+		if (moves > 8)
+			return false;
+	}
+	return true;
+}
+
+template <typename It, typename Compare>
+void sort3(It a, It b, It c, Compare comp)
+{
+	if (comp(*b, *a))
+		std::iter_swap(a, b);
+	if (comp(*c, *b))
+		std::iter_swap(b, c);
+	if (comp(*b, *a))
+		std::iter_swap(a, b);
+}
+
+/**
+ * Pattern-defeating quicksort loop: median-of-3 (ninther on big ranges)
+ * pivot, heapsort once too many partitions came out unbalanced, and a
+ * bounded insertion sort pass when a partition found nothing to swap.
+ */
+template <typename It, typename Compare, typename Small>
+void introLoop(It first, It last, Compare comp, int badAllowed, Small small)
+{
+	while (last - first > INTRO_SMALL)
+	{
+		size_t n = last - first;
+		It mid = first + n / 2;
+		if (n > 128)
+		{
+			sort3(first, mid, last - 1, comp);
+			sort3(first + 1, mid - 1, last - 2, comp);
+			sort3(first + 2, mid + 1, last - 3, comp);
+			sort3(mid - 1, mid, mid + 1, comp);
+		}
+		else
+			sort3(first, mid, last - 1, comp);
+		std::iter_swap(first, mid);
+
+		// Partition [first + 1, last) around the pivot kept in *first
+		It lo = first + 1;
+		It hi = last - 1;
+		bool swapped = false;
+		while (true)
+		{
+			while (lo <= hi && comp(*lo, *first))
+				++lo;
+			while (lo <= hi && comp(*first, *hi))
+				--hi;
+			if (lo >= hi)
+				break;
+			std::iter_swap(lo, hi);
+			swapped = true;
+			++lo;
+			--hi;
+		}
+		It pivot = lo - 1;
+		std::iter_swap(first, pivot);
+
+		size_t left = pivot - first;
+		size_t right = last - pivot - 1;
+		if (left < n / 8 || right < n / 8)
+		{
+			if (--badAllowed <= 0)
+			{
+				std::make_heap(first, last, comp);
+				std::sort_heap(first, last, comp);
+				return;
+			}
+			// Break the pattern that made the pivot bad
+			if (left >= INTRO_SMALL)
+				std::iter_swap(first, first + left / 2);
+			if (right >= INTRO_SMALL)
+				std::iter_swap(pivot + 1, pivot + 1 + right / 2);
+		}
+		else if (!swapped && partialInsertionSort(first, pivot, comp) && partialInsertionSort(pivot + 1, last, comp))
+			return;
+
+		// Recurse into the smaller side, loop on the bigger one
+		if (left < right)
+		{
+			introLoop(first, pivot, comp, badAllowed, small);
+			first = pivot + 1;
+		}
+		else
+		{
+			introLoop(pivot + 1, last, comp, badAllowed, small);
+			last = pivot;
+		}
+	}
+	smallSort(first, last, comp, small);
+}
+
+template <typename It, typename Compare>
+void introSort(It first, It last, Compare comp)
+{
+	typedef typename std::iterator_traits<It>::value_type V;
+	int depth = 0;
+
+	for (size_t n = last - first; n > 1; n >>= 1)
+		depth++;
+	introLoop(first, last, comp, depth, BoolTag<Radixable<V, Compare>::value>());
+}
+
+/**
+ * std::lower_bound written with conditional moves instead of a branch, so a
+ * mispredicted comparison does not flush the pipeline. It probes exactly the
+ * same elements, so the comparison count is unchanged. Both possible next
+ * midpoints are prefetched while the current comparison is in flight.
+ */
+template <typename It, typename V, typename Compare>
+It searchLowerBound(It first, size_t len, const V &val, const Compare &comp)
+{
+	while (len > 0)
+	{
+		size_t half = len / 2;
+		if (len >= 8)
+		{
+			__builtin_prefetch(&first[half / 2]);
+			__builtin_prefetch(&first[half + 1 + (len - half - 1) / 2]);
+		}
+		bool right = comp(first[half], val);
+		first += right ? half + 1 : 0;
+		len = right ? len - half - 1 : half;
+	}
+	return first;
+}
+
+/**
+ * LSD radix sort on 32-bit ints, 8 bits per pass. The sign bit is flipped
+ * so negative values order correctly, and passes where every key falls in
+ * the same bucket are skipped.
+ */
+template <typename T>
+void radixSort(T &container)
+{
+	size_t n = container.size();
+	std::vector<unsigned int> keys(n);
+	std::vector<unsigned int> tmp(n);
+
+	if (n <= 1)
+		return;
+	for (size_t i = 0; i < n; i++)
+		keys[i] = static_cast<unsigned int>(container[i]) ^ 0x80000000u;
+
+	for (int shift = 0; shift < 32; shift += 8)
+	{
+		size_t count[257] = {0};
+		for (size_t i = 0; i < n; i++)
+			count[((keys[i] >> shift) & 0xFF) + 1]++;
+		if (count[((keys[0] >> shift) & 0xFF) + 1] == n)
+			continue;
+		for (int b = 0; b < 256; b++)
+			count[b + 1] += count[b];
+		for (size_t i = 0; i < n; i++)
+			tmp[count[(keys[i] >> shift) & 0xFF]++] = keys[i];
+		keys.swap(tmp);
+	}
+
+	for (size_t i = 0; i < n; i++)
+		container[i] = static_cast<int>(keys[i] ^ 0x80000000u);
+}
+
+#endif
@@ -0,0 +1,147 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   Benchmark.cpp                                      :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: pol <pol@student.42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 16:10:07 by pol               #+#    #+#             */
+/*   Updated: 2026/10/19 16:10:07 by pol              ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "Benchmark.hpp"
+#include <algorithm>
+#include <new>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+double monotonicUs()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000.0 + ts.tv_nsec / 1000.0;
+}
+
+/**
+ * ALLOCATION COUNTING
+ *
+ * The global operator new is replaced so container allocations can be
+ * counted; the counter is atomic because the sort may run on several threads.
+ * Outside of countAllocations(true) it costs a single well-predicted branch.
+ */
+static unsigned long g_allocations = 0;
+static bool g_counting = false;
+
+unsigned long allocationCount() { return __sync_fetch_and_add(&g_allocations, 0UL); }
+
+// Only switched while no sorting thread runs, pthread_create orders the rest
+void countAllocations(bool on) { g_counting = on; }
+
+void *operator new(size_t size) throw(std::bad_alloc)
+{
+	if (g_counting)
+		__sync_fetch_and_add(&g_allocations, 1UL);
+	void *p = std::malloc(size ? size : 1);
+	if (!p)
+		throw std::bad_alloc();
+	return p;
+}
+
+void *operator new[](size_t size) throw(std::bad_alloc) { return operator new(size); }
+void operator delete(void *p) throw() { std::free(p); }
+void operator delete[](void *p) throw() { std::free(p); }
+
+Summary summarize(std::vector<double> samples)
+{
+	Summary s = {0, 0, 0};
+
+	if (samples.empty())
+		return s;
+	std::sort(samples.begin(), samples.end());
+	size_t n = samples.size();
+	size_t p99 = (n * 99 + 99) / 100;
+	s.min = samples[0];
+	s.median = (n % 2) ? samples[n / 2] : (samples[n / 2 - 1] + samples[n / 2]) / 2;
+	s.p99 = samples[(p99 > 0 ? p99 : 1) - 1];
+	return s;
+}
+
+/**
+ * PERF COUNTERS
+ */
+PerfCounters::PerfCounters()
+{
+	const unsigned long long config[NB_COUNTERS] = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_CACHE_MISSES,
+													PERF_COUNT_HW_BRANCH_MISSES};
+
+	for (int i = 0; i < NB_COUNTERS; i++)
+	{
+		struct perf_event_attr attr;
+		std::memset(&attr, 0, sizeof(attr));
+		attr.size = sizeof(attr);
+		attr.type = PERF_TYPE_HARDWARE;
+		attr.config = config[i];
+		attr.disabled = 1;
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+		attr.inherit = 1; // also count the threads started by setThreads()
+		_fd[i] = syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+		_value[i] = 0;
+	}
+}
+
+PerfCounters::~PerfCounters()
+{
+	for (int i = 0; i < NB_COUNTERS; i++)
+		if (_fd[i] >= 0)
+			close(_fd[i]);
+}
+
+bool PerfCounters::available() const { return _fd[CYCLES] >= 0; }
+
+void PerfCounters::start()
+{
+	for (int i = 0; i < NB_COUNTERS; i++)
+	{
+		if (_fd[i] < 0)
+			continue;
+		ioctl(_fd[i], PERF_EVENT_IOC_RESET, 0);
+		ioctl(_fd[i], PERF_EVENT_IOC_ENABLE, 0);
+	}
+}
+
+void PerfCounters::stop()
+{
+	for (int i = 0; i < NB_COUNTERS; i++)
+	{
+		_value[i] = 0;
+		if (_fd[i] < 0)
+			continue;
+		ioctl(_fd[i], PERF_EVENT_IOC_DISABLE, 0);
+		if (read(_fd[i], &_value[i], sizeof(_value[i])) != sizeof(_value[i]))
+			_value[i] = 0;
+	}
+}
+
+unsigned long long PerfCounters::value(Counter c) const { return _value[c]; }
+
+const char *PerfCounters::name(Counter c)
+{
+	switch (c)
+	{
+	case CYCLES:
+		return "cycles";
+	case CACHE_MISSES:
+		return "cache-misses";
+	case BRANCH_MISSES:
+		return "branch-misses";
+	default:
+		return "unknown";
+	}
+}
@@ -0,0 +1,415 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   ExternalSort.cpp                                   :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: pol <pol@student.42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 14:48:41 by pol               #+#    #+#             */
+/*   Updated: 2026/10/19 14:48:41 by pol              ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "ExternalSort.hpp"
+#include "PmergeMe.hpp"
+#include "InputReader.hpp"
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+// How many values are kept for the Before/After lines
+#define HEAD_SIZE 12
+
+// Largest input block read at once during the run phase (1 MiB)
+#define MAX_READ_BLOCK (1 << 20)
+
+// Smallest read buffer per run during the merge (16 KiB), a smaller budget
+// lowers the fan-in and adds merge passes instead
+#define MIN_RUN_BUFFER (1 << 12)
+
+// Smallest output buffer (16 KiB)
+#define MIN_OUT_BUFFER (1 << 14)
+
+/**
+ * LOSER TREE
+ */
+LoserTree::LoserTree() {}
+
+LoserTree::LoserTree(const LoserTree &src) { *this = src; }
+
+LoserTree &LoserTree::operator=(const LoserTree &src)
+{
+	if (this != &src)
+	{
+		_tree = src._tree;
+		_keys = src._keys;
+		_done = src._done;
+	}
+	return *this;
+}
+
+LoserTree::~LoserTree() {}
+
+// Ties go to the lower run index, which keeps the merge deterministic
+bool LoserTree::beats(size_t a, size_t b) const
+{
+	if (_done[a])
+		return false;
+	if (_done[b])
+		return true;
+	return _keys[a] < _keys[b] || (_keys[a] == _keys[b] && a < b);
+}
+
+// Leaves are k..2k-1, internal nodes 1..k-1 keep the loser of their match
+void LoserTree::build(const std::vector<int> &heads, const std::vector<bool> &done)
+{
+	size_t k = heads.size();
+	std::vector<size_t> winners(2 * k);
+
+	_keys = heads;
+	_done = done;
+	_tree.assign(k, 0);
+	for (size_t i = 0; i < k; i++)
+		winners[k + i] = i;
+	for (size_t n = k - 1; n >= 1; n--)
+	{
+		size_t l = winners[2 * n];
+		size_t r = winners[2 * n + 1];
+		winners[n] = beats(l, r) ? l : r;
+		_tree[n] = beats(l, r) ? r : l;
+	}
+	_tree[0] = winners[1];
+}
+
+size_t LoserTree::winner() const { return _tree[0]; }
+int LoserTree::top() const { return _keys[_tree[0]]; }
+bool LoserTree::empty() const { return _tree.empty() || _done[_tree[0]]; }
+
+void LoserTree::replace(int key, bool done)
+{
+	size_t k = _tree.size();
+	size_t w = _tree[0];
+
+	_keys[w] = key;
+	_done[w] = done;
+	for (size_t n = (w + k) / 2; n >= 1; n /= 2)
+	{
+		if (beats(_tree[n], w))
+			std::swap(_tree[n], w);
+	}
+	_tree[0] = w;
+}
+
+/**
+ * EXTERNAL SORT
+ */
+ExternalSort::ExternalSort(PmergeMe &sorter, size_t budget)
+	: _sorter(&sorter), _budget(budget), _count(0), _runCount(0), _merges(0), _bytesRead(0), _bytesWritten(0), _runTime(0), _mergeTime(0) {}
+
+ExternalSort::~ExternalSort() { closeRuns(); }
+
+void ExternalSort::closeRuns()
+{
+	for (size_t i = 0; i < _runFds.size(); i++)
+		close(_runFds[i]);
+	_runFds.clear();
+	_runSizes.clear();
+}
+
+static void writeAll(int fd, const char *data, size_t len)
+{
+	while (len > 0)
+	{
+		ssize_t n = write(fd, data, len);
+		if (n <= 0)
+			throw ExternalSort::ErrorException();
+		data += n;
+		len -= n;
+	}
+}
+
+// Reads up to len bytes, short only at end of file
+static size_t readAll(int fd, char *data, size_t len)
+{
+	size_t total = 0;
+	while (total < len)
+	{
+		ssize_t n = read(fd, data + total, len - total);
+		if (n < 0)
+			throw ExternalSort::ErrorException();
+		if (n == 0)
+			break;
+		total += n;
+	}
+	return total;
+}
+
+// Runs go to an unlinked file in $TMPDIR, the kernel drops it once the
+// descriptor is closed (merged away, next run() or destruction)
+int ExternalSort::tempFile()
+{
+	const char *dir = std::getenv("TMPDIR");
+	std::string path = std::string(dir ? dir : "/tmp") + "/pmergeme-run-XXXXXX";
+	std::vector<char> name(path.begin(), path.end());
+	name.push_back('\0');
+
+	int fd = mkstemp(&name[0]);
+	if (fd < 0)
+		throw ErrorException();
+	unlink(&name[0]);
+	return fd;
+}
+
+void ExternalSort::spill(const std::vector<int> &run)
+{
+	int fd = tempFile();
+	_runFds.push_back(fd);
+	_runSizes.push_back(run.size());
+
+	writeAll(fd, reinterpret_cast<const char *>(&run[0]), run.size() * sizeof(int));
+	_bytesWritten += run.size() * sizeof(int);
+	if (lseek(fd, 0, SEEK_SET) < 0)
+		throw ErrorException();
+}
+
+void ExternalSort::run(const std::string &input, const std::string &output, bool binary)
+{
+	closeRuns();
+	_head.clear();
+	_sortedHead.clear();
+	_count = _runCount = _merges = 0;
+	_bytesRead = _bytesWritten = 0;
+	_runTime = _mergeTime = 0;
+
+	// Open the output first, a bad path should not cost the whole run phase
+	int outFd = -1;
+	if (output == "-")
+		outFd = 1;
+	else if (!output.empty())
+		outFd = open(output.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (!output.empty() && outFd < 0)
+		throw ErrorException();
+
+	try
+	{
+		sortRuns(input, binary);
+		double start = monotonicUs();
+		merge(outFd, binary);
+		_mergeTime = monotonicUs() - start;
+	}
+	catch (...)
+	{
+		if (outFd > 1)
+			close(outFd);
+		throw;
+	}
+	if (outFd > 1)
+		close(outFd);
+}
+
+void ExternalSort::sortRuns(const std::string &input, bool binary)
+{
+	InputReader reader;
+
+	// The reader keeps a block of input, the rest goes to the run. Radix sort
+	// needs two scratch arrays the size of the run, so a run gets a third.
+	size_t block = _budget / 16;
+	if (block > MAX_READ_BLOCK)
+		block = MAX_READ_BLOCK;
+	size_t capacity = (_budget - block) / (3 * sizeof(int));
+	if (capacity < 1024)
+		capacity = 1024;
+
+	// Ford-Johnson holds several index arrays per run and moves O(n^2)
+	// elements, it fits no budget: runs take radix unless -e asked otherwise
+	bool radix = (_sorter->getEngine() == PmergeMe::ENGINE_MIN_COMPARISONS);
+
+	double start = monotonicUs();
+	reader.setBufferLimit(block);
+	reader.open(input, binary);
+	std::vector<int> run;
+	run.reserve(capacity);
+	while (true)
+	{
+		run.clear();
+		if (reader.read(run, capacity) == 0)
+			break;
+		for (size_t i = 0; i < run.size() && _head.size() < HEAD_SIZE; i++)
+			_head.push_back(run[i]);
+		if (radix)
+			radixSort(run);
+		else
+			_sorter->hybridSort(run);
+		spill(run);
+		_count += run.size();
+	}
+	_runCount = _runFds.size();
+	_bytesRead += reader.bytesRead();
+	_runTime = monotonicUs() - start;
+}
+
+// Per-run read buffer during the merge
+struct RunBuffer
+{
+	std::vector<int> data;
+	size_t pos;
+	size_t len;
+	size_t left;
+};
+
+// Half the budget is shared by the run buffers, so this many runs can be
+// merged at once without going under MIN_RUN_BUFFER each
+size_t ExternalSort::fanIn() const
+{
+	size_t k = _budget / 2 / (MIN_RUN_BUFFER * sizeof(int));
+	return (k < 2) ? 2 : k;
+}
+
+void ExternalSort::merge(int outFd, bool binary)
+{
+	size_t k = fanIn();
+
+	// Too many runs for one pass: merge the oldest k into a new run at the
+	// back until the rest fit. Every descriptor stays in _runFds meanwhile,
+	// so an exception cannot leak one.
+	while (_runFds.size() > k)
+	{
+		int fd = tempFile();
+		_runFds.push_back(fd);
+		_runSizes.push_back(0);
+		_runSizes.back() = mergeRuns(k, fd, false, true);
+		if (lseek(fd, 0, SEEK_SET) < 0)
+			throw ErrorException();
+		for (size_t i = 0; i < k; i++)
+			close(_runFds[i]);
+		_runFds.erase(_runFds.begin(), _runFds.begin() + k);
+		_runSizes.erase(_runSizes.begin(), _runSizes.begin() + k);
+		_merges++;
+	}
+	if (!_runFds.empty())
+	{
+		mergeRuns(_runFds.size(), outFd, binary, false);
+		_merges++;
+	}
+}
+
+/**
+ * Merges the first k runs into outFd (or only into _sortedHead when outFd
+ * is -1). An intermediate merge writes native ints, like spill(), and
+ * leaves _sortedHead alone. Returns the number of values written.
+ */
+size_t ExternalSort::mergeRuns(size_t k, int outFd, bool binary, bool intermediate)
+{
+	size_t perRun = _budget / 2 / (k * sizeof(int));
+	if (perRun < MIN_RUN_BUFFER)
+		perRun = MIN_RUN_BUFFER;
+	// The output buffer gets a quarter of the budget
+	size_t outSize = _budget / 4;
+	if (outSize < MIN_OUT_BUFFER)
+		outSize = MIN_OUT_BUFFER;
+
+	std::vector<RunBuffer> runs(k);
+	std::vector<int> heads(k);
+	std::vector<bool> done(k);
+	for (size_t i = 0; i < k; i++)
+	{
+		runs[i].data.resize(perRun);
+		runs[i].pos = runs[i].len = 0;
+		runs[i].left = _runSizes[i];
+	}
+
+	std::vector<char> out(outSize + 16);
+	size_t outLen = 0;
+	size_t written = 0;
+	LoserTree tree;
+
+	for (size_t i = 0; i < k; i++)
+	{
+		RunBuffer &r = runs[i];
+		size_t want = (r.left < perRun) ? r.left : perRun;
+		r.len = readAll(_runFds[i], reinterpret_cast<char *>(&r.data[0]), want * sizeof(int)) / sizeof(int);
+		r.left -= r.len;
+		_bytesRead += r.len * sizeof(int);
+		done[i] = (r.len == 0);
+		heads[i] = done[i] ? 0 : r.data[0];
+	}
+	tree.build(heads, done);
+
+	while (!tree.empty())
+	{
+		int v = tree.top();
+		RunBuffer &r = runs[tree.winner()];
+
+		if (!intermediate && _sortedHead.size() < HEAD_SIZE)
+			_sortedHead.push_back(v);
+		if (outFd >= 0)
+		{
+			if (intermediate)
+			{
+				std::memcpy(&out[outLen], &v, sizeof(int));
+				outLen += sizeof(int);
+			}
+			else if (binary)
+			{
+				unsigned int u = static_cast<unsigned int>(v);
+				out[outLen++] = u & 0xFF;
+				out[outLen++] = (u >> 8) & 0xFF;
+				out[outLen++] = (u >> 16) & 0xFF;
+				out[outLen++] = (u >> 24) & 0xFF;
+			}
+			else
+			{
+				char digits[12];
+				int n = 0;
+				unsigned int u = static_cast<unsigned int>(v);
+				do
+				{
+					digits[n++] = '0' + u % 10;
+					u /= 10;
+				} while (u);
+				while (n > 0)
+					out[outLen++] = digits[--n];
+				out[outLen++] = '\n';
+			}
+			if (outLen >= outSize)
+			{
+				writeAll(outFd, &out[0], outLen);
+				_bytesWritten += outLen;
+				outLen = 0;
+			}
+		}
+		written++;
+
+		// Advance the winning run, refilling its buffer when drained
+		if (++r.pos == r.len && r.left > 0)
+		{
+			size_t i = tree.winner();
+			size_t want = (r.left < perRun) ? r.left : perRun;
+			r.len = readAll(_runFds[i], reinterpret_cast<char *>(&r.data[0]), want * sizeof(int)) / sizeof(int);
+			if (r.len == 0)
+				throw ErrorException();
+			r.left -= r.len;
+			r.pos = 0;
+			_bytesRead += r.len * sizeof(int);
+		}
+		if (r.pos < r.len)
+			tree.replace(r.data[r.pos], false);
+		else
+			tree.replace(0, true);
+	}
+	if (outLen > 0)
+		writeAll(outFd, &out[0], outLen);
+	_bytesWritten += outLen;
+	return written;
+}
+
+size_t ExternalSort::count() const { return _count; }
+size_t ExternalSort::runCount() const { return _runCount; }
+size_t ExternalSort::merges() const { return _merges; }
+const std::vector<int> &ExternalSort::head() const { return _head; }
+const std::vector<int> &ExternalSort::sortedHead() const { return _sortedHead; }
+unsigned long ExternalSort::bytesRead() const { return _bytesRead; }
+unsigned long ExternalSort::bytesWritten() const { return _bytesWritten; }
+double ExternalSort::runTime() const { return _runTime; }
+double ExternalSort::mergeTime() const { return _mergeTime; }
@@ -0,0 +1,242 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   InputReader.cpp                                    :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: pol <pol@student.42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 14:05:16 by pol               #+#    #+#             */
+/*   Updated: 2026/10/19 14:05:16 by pol              ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "InputReader.hpp"
+#include <cstring>
+#include <cerrno>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// Pipes are read this much at a time
+#define READ_BLOCK (1 << 20)
+
+// Longest token scanNumber may look at before giving up
+#define MAX_TOKEN 32
+
+/**
+ * WORD-AT-A-TIME NUMBER SCANNING
+ *
+ * Eight bytes are loaded at once: one test tells whether they are all digits
+ * and, if so, three multiplications turn them into their value. Anything
+ * shorter or longer is finished byte by byte.
+ */
+static uint64_t load8(const char *p)
+{
+	uint64_t v;
+	std::memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+static bool isEightDigits(uint64_t v)
+{
+	return (((v & 0xF0F0F0F0F0F0F0F0ULL) | (((v + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4)) == 0x3333333333333333ULL);
+}
+
+static uint32_t parseEightDigits(uint64_t v)
+{
+	const uint64_t mask = 0x000000FF000000FFULL;
+	const uint64_t mul1 = 100 + (1000000ULL << 32);
+	const uint64_t mul2 = 1 + (10000ULL << 32);
+
+	v -= 0x3030303030303030ULL;
+	v = (v * 10) + (v >> 8);
+	v = (((v & mask) * mul1) + (((v >> 16) & mask) * mul2)) >> 32;
+	return static_cast<uint32_t>(v);
+}
+
+// Counts the bytes <= ' ' in a word (exact, no carries between bytes)
+static int countSeparators(uint64_t v)
+{
+	const uint64_t ones = 0x0101010101010101ULL;
+	return __builtin_popcountll(((ones * (127 + 33)) - (v & (ones * 127))) & ~v & (ones * 128));
+}
+
+static bool isSeparator(char c) { return c == ' ' || (c >= '\t' && c <= '\r'); }
+
+bool scanNumber(const char *&p, const char *end, int &out)
+{
+	const char *first = p;
+	uint64_t val = 0;
+
+	// Leading zeros do not count towards the length limit
+	while (p < end && *p == '0')
+		p++;
+	const char *start = p;
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+	if (end - p >= 8 && isEightDigits(load8(p)))
+	{
+		val = parseEightDigits(load8(p));
+		p += 8;
+	}
+#endif
+	while (p < end && *p >= '0' && *p <= '9')
+	{
+		val = val * 10 + (*p - '0');
+		if (++p - start > 18)
+			return false;
+	}
+	if (p == first || (p < end && !isSeparator(*p)) || val > 2147483647)
+		return false;
+	out = static_cast<int>(val);
+	return true;
+}
+
+InputReader::InputReader()
+	: _fd(-1), _binary(false), _eof(true), _map(NULL), _mapLen(0), _pos(NULL), _end(NULL), _bytesRead(0),
+	  _bufferLimit(0) {}
+
+InputReader::~InputReader() { close(); }
+
+void InputReader::close()
+{
+	if (_map)
+		munmap(const_cast<char *>(_map), _mapLen);
+	if (_fd > 0)
+		::close(_fd);
+	_map = NULL;
+	_fd = -1;
+}
+
+void InputReader::open(const std::string &path, bool binary)
+{
+	struct stat st;
+
+	close();
+	_binary = binary;
+	_eof = false;
+	_pos = _end = NULL;
+	_fd = (path == "-") ? 0 : ::open(path.c_str(), O_RDONLY);
+	if (_fd < 0 || fstat(_fd, &st) < 0)
+		throw ErrorException();
+
+	// Mapping a file pages all of it in eventually, which a limit rules out
+	if (S_ISREG(st.st_mode) && st.st_size > 0 && _bufferLimit == 0)
+	{
+		_mapLen = st.st_size;
+		void *map = mmap(NULL, _mapLen, PROT_READ, MAP_PRIVATE, _fd, 0);
+		if (map == MAP_FAILED)
+			throw ErrorException();
+		madvise(map, _mapLen, MADV_SEQUENTIAL);
+		_map = static_cast<const char *>(map);
+		_pos = _map;
+		_end = _map + _mapLen;
+		_eof = true;
+		_bytesRead = _mapLen;
+	}
+}
+
+void InputReader::setBufferLimit(size_t bytes) { _bufferLimit = bytes; }
+
+// Keeps the unread tail and appends the next block behind it
+bool InputReader::refill()
+{
+	if (_eof)
+		return false;
+
+	// Move the tail to the front before resizing, resize may reallocate
+	size_t block = _bufferLimit ? _bufferLimit : READ_BLOCK;
+	size_t left = _end - _pos;
+	if (left > 0)
+		std::memmove(&_buf[0], _pos, left);
+	if (_buf.size() < left + block)
+		_buf.resize(left + block);
+
+	ssize_t n;
+	do
+		n = ::read(_fd, &_buf[left], block);
+	while (n < 0 && errno == EINTR);
+	if (n < 0)
+		throw ErrorException();
+	if (n == 0)
+		_eof = true;
+	_bytesRead += n;
+	_pos = &_buf[0];
+	_end = _pos + left + n;
+	return n > 0;
+}
+
+size_t InputReader::read(std::vector<int> &out, size_t max)
+{
+	size_t count = 0;
+
+	while (count < max)
+	{
+		if (_binary)
+		{
+			// A pipe may hand over a value in pieces
+			while (_end - _pos < 4 && refill())
+				;
+			if (_end - _pos < 4)
+			{
+				if (_pos != _end)
+					throw ErrorException();
+				break;
+			}
+			const unsigned char *b = reinterpret_cast<const unsigned char *>(_pos);
+			uint32_t v = b[0] | (b[1] << 8) | (b[2] << 16) | (static_cast<uint32_t>(b[3]) << 24);
+			if (v > 2147483647u)
+				throw ErrorException();
+			out.push_back(static_cast<int>(v));
+			_pos += 4;
+			count++;
+			continue;
+		}
+
+		while (_pos < _end && isSeparator(*_pos))
+			_pos++;
+		if (_end - _pos < MAX_TOKEN && !_eof)
+		{
+			refill();
+			continue;
+		}
+		if (_pos == _end)
+			break;
+		int val;
+		const char *p = _pos;
+		bool ok = scanNumber(p, _end, val);
+		if (p == _end && !_eof)
+		{
+			// The token may go on in the next block (long runs of zeros)
+			refill();
+			continue;
+		}
+		if (!ok)
+			throw ErrorException();
+		_pos = p;
+		out.push_back(val);
+		count++;
+	}
+	return count;
+}
+
+// One number per separator, counted a word at a time over the mapping
+size_t InputReader::sizeHint() const
+{
+	if (!_map)
+		return 0;
+	if (_binary)
+		return _mapLen / 4;
+
+	size_t estimate = 1;
+	size_t i = 0;
+	for (; i + 8 <= _mapLen; i += 8)
+		estimate += countSeparators(load8(_map + i));
+	for (; i < _mapLen; i++)
+		estimate += isSeparator(_map[i]);
+	return estimate;
+}
+
+unsigned long InputReader::bytesRead() const { return _bytesRead; }
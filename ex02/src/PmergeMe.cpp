@@ -11,8 +11,14 @@
 /* ************************************************************************** */
 
 #include "PmergeMe.hpp"
+#include "InputReader.hpp"
+#include "ExternalSort.hpp"
+#include <cstring>
+#include <cstdlib>
 
-PmergeMe::PmergeMe() : _vecTime(0), _deqTime(0) {}
+PmergeMe::PmergeMe() : _vecTime(0), _deqTime(0), _threads(1),
+					   _engine(ENGINE_MIN_COMPARISONS), _costlyCompare(false), _inputBinary(false),
+					   _memoryBudget(0), _iterations(0) {}
 
 PmergeMe::~PmergeMe() {}
 
@@ -26,117 +32,305 @@ PmergeMe &PmergeMe::operator=(const PmergeMe &src)
 		_deq = src._deq;
 		_vecTime = src._vecTime;
 		_deqTime = src._deqTime;
+		_threads = src._threads;
+		_engine = src._engine;
+		_costlyCompare = src._costlyCompare;
+		_inputPath = src._inputPath;
+		_inputBinary = src._inputBinary;
+		_memoryBudget = src._memoryBudget;
+		_outputPath = src._outputPath;
+		_iterations = src._iterations;
 	}
 	return *this;
 }
 
-// Generates Jacobsthal numbers: Jn = Jn-1 + 2*Jn-2
-std::vector<int> PmergeMe::generateJacobsthal(int n)
+void PmergeMe::setThreads(size_t threads) { _threads = (threads < 1) ? 1 : threads; }
+size_t PmergeMe::getThreads() const { return _threads; }
+
+void PmergeMe::setEngine(Engine engine) { _engine = engine; }
+PmergeMe::Engine PmergeMe::getEngine() const { return _engine; }
+void PmergeMe::setCostlyCompare(bool costly) { _costlyCompare = costly; }
+
+const char *PmergeMe::engineName(Engine engine)
 {
-	std::vector<int> jacob;
-	// begin at 3 to have the first bloc as [3, 2, 1]
-	int j0 = 3;
-	int j1 = 5;
+	switch (engine)
+	{
+	case ENGINE_AUTO:
+		return "auto";
+	case ENGINE_MIN_COMPARISONS:
+		return "ford-johnson";
+	case ENGINE_RADIX:
+		return "radix";
+	case ENGINE_NETWORK:
+		return "network";
+	case ENGINE_INTROSORT:
+		return "introsort";
+	}
+	return "unknown";
+}
 
-	if (n > 1)
-		jacob.push_back(j0);
-	if (n > 3)
-		jacob.push_back(j1);
+// Generates Jacobsthal numbers from 3 (Jn = Jn-1 + 2*Jn-2): 3, 5, 11, 21, 43...
+// until one reaches n
+std::vector<size_t> PmergeMe::generateJacobsthal(size_t n)
+{
+	std::vector<size_t> jacob;
+	size_t prev = 1;
+	size_t cur = 3;
 
-	while (true)
+	jacob.push_back(cur);
+	while (cur < n)
 	{
-		int next = jacob.back() + 2 * jacob[jacob.size() - 2];
-		if (next >= n + 2)
-			break;
-		jacob.push_back(next);
+		size_t next = cur + 2 * prev;
+		prev = cur;
+		cur = next;
+		jacob.push_back(cur < n ? cur : n);
 	}
 	return jacob;
 }
 
-std::vector<int> PmergeMe::buildInsertionOrder(int size)
+// In 1-based labels, pend element b1 is inserted first for free, then the
+// groups go b3 b2, b5 b4, b11 ... b6, b21 ... b12: each one from the next
+// Jacobsthal number down to the previous one. Every element of group k is
+// then searched among at most 2^k - 1 elements. The order holds 0-based
+// pend indices (label - 1).
+std::vector<size_t> PmergeMe::buildInsertionOrder(size_t size)
 {
-	std::vector<int> order;
+	std::vector<size_t> order;
 	if (size <= 1)
 		return order;
+	order.reserve(size - 1);
 
-	// get jacobsthal numbers
-	std::vector<int> jacob = generateJacobsthal(size);
-
-	// We start at 0 because the index 0 is manually inserted before
-	// This allows the first block to descend to index 1
-	int lastLimit = 0;
+	std::vector<size_t> jacob = generateJacobsthal(size);
+	size_t lastLabel = 1;
 
-	for (size_t i = 0; i < jacob.size(); i++)
+	for (size_t i = 0; i < jacob.size() && lastLabel < size; i++)
 	{
-		// We can't exceed the last available index (size - 1)
-		int upperLimit = (jacob[i] >= size) ? size - 1 : jacob[i];
+		// The last group is cut at the end of pend
+		size_t upperLabel = (jacob[i] > size) ? size : jacob[i];
 
-		// We insert in reverse until the previous limit
-		// Exemple : if upperLimit = 3 and lastLimit = 0 -> we add 3, 2, 1
-		for (int j = upperLimit; j > lastLimit; j--)
-		{
-			order.push_back(j);
-		}
+		for (size_t label = upperLabel; label > lastLabel; label--)
+			order.push_back(label - 1);
+		lastLabel = upperLabel;
+	}
+	return order;
+}
 
-		// update the limit for the next block
-		if (upperLimit > lastLimit)
-			lastLimit = upperLimit;
+void PmergeMe::parseInput(int ac, char **av)
+{
+	_vec.reserve(ac > 1 ? ac - 1 : 0);
 
-		// If we have reached the end of the Pend, we stop
-		if (upperLimit >= size - 1)
-			break;
+	// Iterate through each command line argument starting from index 1
+	for (int i = 1; i < ac; i++)
+	{
+		// VALIDATION: digits only, fits in a positive 32-bit int
+		const char *p = av[i];
+		const char *end = p + std::strlen(p);
+		int val;
+		if (!scanNumber(p, end, val) || p != end)
+			throw ErrorException();
+		_vec.push_back(val);
 	}
 
-	// Security : we add the remaining elements that would not have been
-	// subsequently covered by Jacobsthal (case of very large paintings)
-	for (int i = 1; i < size; i++)
+	// STORAGE: the deque gets the validated numbers in one go
+	_deq.assign(_vec.begin(), _vec.end());
+}
+
+/**
+ * Text or binary input from a file ("-" for stdin), see InputReader.
+ * The vector is reserved from the reader's estimate, then the deque is
+ * filled from the vector in one go.
+ */
+void PmergeMe::parseFile(const std::string &path, bool binary)
+{
+	InputReader reader;
+
+	reader.open(path, binary);
+	_vec.reserve(reader.sizeHint());
+	reader.read(_vec, static_cast<size_t>(-1));
+	_deq.assign(_vec.begin(), _vec.end());
+}
+
+void PmergeMe::setInputFile(const std::string &path, bool binary)
+{
+	_inputPath = path;
+	_inputBinary = binary;
+}
+
+void PmergeMe::setMemoryBudget(size_t bytes) { _memoryBudget = bytes; }
+void PmergeMe::setOutputFile(const std::string &path) { _outputPath = path; }
+void PmergeMe::setIterations(size_t iterations) { _iterations = iterations; }
+
+static void printHead(const char *label, const std::vector<int> &head, size_t total)
+{
+	std::cout << label;
+	for (size_t i = 0; i < head.size(); i++)
+		std::cout << head[i] << (i == head.size() - 1 && total == head.size() ? "" : " ");
+	if (total > head.size())
+		std::cout << "[...]";
+	std::cout << std::endl;
+}
+
+/**
+ * Out-of-core sort of _inputPath into _outputPath. The containers are not
+ * used at all, the data only ever lives in one run buffer at a time.
+ */
+void PmergeMe::executeExternal()
+{
+	ExternalSort ext(*this, _memoryBudget);
+
+	ext.run(_inputPath, _outputPath, _inputBinary);
+	if (ext.count() == 0)
+		return;
+
+	printHead("Before: ", ext.head(), ext.count());
+	printHead("After:  ", ext.sortedHead(), ext.count());
+
+	double total = ext.runTime() + ext.mergeTime();
+	double mb = 1024.0 * 1024.0;
+	std::cout << "Time to process a range of " << ext.count() << " elements out of core (" << ext.runCount()
+			  << " runs, " << ext.merges() << " merges) : " << std::fixed << std::setprecision(5) << total << " us" << std::endl;
+	std::cout << "  runs  : " << ext.runTime() << " us" << std::endl;
+	std::cout << "  merge : " << ext.mergeTime() << " us" << std::endl;
+	std::cout << "I/O: " << std::setprecision(1) << ext.bytesRead() / mb << " MiB read, " << ext.bytesWritten() / mb
+			  << " MiB written, " << (ext.bytesRead() + ext.bytesWritten()) / mb / (total / 1000000.0) << " MiB/s" << std::endl;
+}
+
+/**
+ * BENCHMARK MODE
+ *
+ * One timed trial: the copy is made before the clock starts, so every
+ * trial sorts fresh input and only the sort itself is measured.
+ */
+struct TrialResult
+{
+	double us;
+	double allocations;
+	double counters[PerfCounters::NB_COUNTERS];
+};
+
+template <typename T>
+static TrialResult runTrial(PmergeMe &sorter, const T &input, PerfCounters &perf)
+{
+	TrialResult r;
+	T c(input);
+
+	unsigned long allocs = allocationCount();
+	perf.start();
+	double start = monotonicUs();
+	sorter.hybridSort(c);
+	r.us = monotonicUs() - start;
+	perf.stop();
+	r.allocations = allocationCount() - allocs;
+	for (int i = 0; i < PerfCounters::NB_COUNTERS; i++)
+		r.counters[i] = perf.value(static_cast<PerfCounters::Counter>(i));
+	return r;
+}
+
+// Ingestion is reported apart from the sort, in both modes
+static void printIngestTime(size_t n, const std::string &path, double us)
+{
+	std::cout << "Time to ingest " << n << " elements from " << path << "    : " << std::fixed << std::setprecision(5) << us << " us" << std::endl;
+}
+
+// Prints one container's line and returns its median time. Radix sort
+// makes no comparisons at all, so it gets no count.
+static double printSummary(const std::string &name, const std::vector<TrialResult> &trials, unsigned long comparisons,
+						   bool radix, bool perf)
+{
+	std::vector<double> us, allocs;
+	std::vector<double> counters[PerfCounters::NB_COUNTERS];
+
+	for (size_t i = 0; i < trials.size(); i++)
 	{
-		bool found = false;
-		for (size_t j = 0; j < order.size(); j++)
-		{
-			if (order[j] == i)
-			{
-				found = true;
-				break;
-			}
-		}
-		if (!found)
-			order.push_back(i);
+		us.push_back(trials[i].us);
+		allocs.push_back(trials[i].allocations);
+		for (int c = 0; c < PerfCounters::NB_COUNTERS; c++)
+			counters[c].push_back(trials[i].counters[c]);
 	}
 
-	return order;
+	Summary t = summarize(us);
+	std::cout << std::fixed << std::setprecision(3);
+	std::cout << name << " : min " << t.min << " us, median " << t.median << " us, p99 " << t.p99 << " us" << std::endl;
+	std::cout << std::setprecision(0);
+	std::cout << "    comparisons ";
+	if (radix)
+		std::cout << "n/a (radix)";
+	else
+		std::cout << comparisons;
+	std::cout << ", allocations " << summarize(allocs).median;
+	for (int c = 0; perf && c < PerfCounters::NB_COUNTERS; c++)
+		std::cout << ", " << PerfCounters::name(static_cast<PerfCounters::Counter>(c)) << " " << summarize(counters[c]).median;
+	std::cout << " (medians)" << std::endl;
+	return t.median;
 }
 
-void PmergeMe::parseInput(int ac, char **av)
+/**
+ * N trials per container after one warm-up each. Vector and deque trials
+ * are shuffled together so neither always runs on caches the other warmed.
+ * Comparisons come from one extra, untimed run with a counting comparator.
+ */
+void PmergeMe::executeBenchmark()
 {
-	// Iterate through each command line argument starting from index 1
-	for (int i = 1; i < ac; i++)
-	{
-		std::string s(av[i]);
+	PerfCounters perf;
+	unsigned long vecCmp = 0;
+	unsigned long deqCmp = 0;
+	bool vecRadix = (chooseEngine(_vec, std::less<int>()) == ENGINE_RADIX);
+	bool deqRadix = (chooseEngine(_deq, std::less<int>()) == ENGINE_RADIX);
 
-		// VALIDATION: Check if the string is empty or contains non-digit characters
-		// find_first_not_of returns npos if only digits are found
-		if (s.empty() || s.find_first_not_of("0123456789") != std::string::npos)
-			throw ErrorException();
+	countAllocations(true);
 
-		// CONVERSION: Convert string to long to check for overflow before casting
-		long val = std::atol(av[i]);
+	std::vector<int> v(_vec);
+	hybridSort(v, CountingCompare<std::less<int> >(std::less<int>(), &vecCmp));
+	std::deque<int> d(_deq);
+	hybridSort(d, CountingCompare<std::less<int> >(std::less<int>(), &deqCmp));
 
-		// RANGE CHECK: Ensure the number fits in a standard 32-bit positive integer
-		if (val > 2147483647 || val < 0)
-			throw ErrorException();
+	runTrial(*this, _vec, perf);
+	runTrial(*this, _deq, perf);
+
+	std::vector<int> order;
+	for (size_t i = 0; i < 2 * _iterations; i++)
+		order.push_back(i < _iterations);
+	std::srand(static_cast<unsigned int>(monotonicUs()));
+	std::random_shuffle(order.begin(), order.end());
 
-		// STORAGE: Add the validated number to both required containers (vector and deque)
-		_vec.push_back(static_cast<int>(val));
-		_deq.push_back(static_cast<int>(val));
+	std::vector<TrialResult> vecTrials;
+	std::vector<TrialResult> deqTrials;
+	for (size_t i = 0; i < order.size(); i++)
+	{
+		if (order[i])
+			vecTrials.push_back(runTrial(*this, _vec, perf));
+		else
+			deqTrials.push_back(runTrial(*this, _deq, perf));
 	}
+	countAllocations(false);
+
+	_vec.swap(v);
+	_deq.swap(d);
+	printHead("After:  ", std::vector<int>(_vec.begin(), _vec.begin() + std::min<size_t>(_vec.size(), 12)), _vec.size());
+
+	std::cout << "Benchmark of " << _vec.size() << " elements, " << _iterations << " trials per container after a warm-up, "
+			  << "engine " << engineName(_engine) << (perf.available() ? "" : ", perf counters unavailable") << std::endl;
+	_vecTime = printSummary("std::vector", vecTrials, vecCmp, vecRadix, perf.available());
+	_deqTime = printSummary("std::deque ", deqTrials, deqCmp, deqRadix, perf.available());
 }
 
 void PmergeMe::execute(int ac, char **av)
 {
 	try
 	{
-		parseInput(ac, av);
+		if (_memoryBudget > 0)
+		{
+			executeExternal();
+			return;
+		}
+
+		// Ingestion is timed on its own, it is not part of the sort
+		double start = monotonicUs();
+		if (_inputPath.empty())
+			parseInput(ac, av);
+		else
+			parseFile(_inputPath, _inputBinary);
+		double ingestTime = monotonicUs() - start;
 		if (_vec.empty())
 			return;
 
@@ -154,19 +348,23 @@ void PmergeMe::execute(int ac, char **av)
 		}
 		std::cout << std::endl;
 
-		struct timeval start, end;
+		if (_iterations > 0)
+		{
+			executeBenchmark();
+			if (!_inputPath.empty())
+				printIngestTime(_vec.size(), _inputPath, ingestTime);
+			return;
+		}
 
 		// Measure Vector time
-		gettimeofday(&start, NULL);
-		fordJohnsonSort(_vec);
-		gettimeofday(&end, NULL);
-		_vecTime = (end.tv_sec - start.tv_sec) * 1000000.0 + (end.tv_usec - start.tv_usec);
+		start = monotonicUs();
+		hybridSort(_vec);
+		_vecTime = monotonicUs() - start;
 
 		// Measure Deque time
-		gettimeofday(&start, NULL);
-		fordJohnsonSort(_deq);
-		gettimeofday(&end, NULL);
-		_deqTime = (end.tv_sec - start.tv_sec) * 1000000.0 + (end.tv_usec - start.tv_usec);
+		start = monotonicUs();
+		hybridSort(_deq);
+		_deqTime = monotonicUs() - start;
 
 		// AFTER
 		std::cout << "After:  ";
@@ -184,6 +382,8 @@ void PmergeMe::execute(int ac, char **av)
 		// TIMES
 		std::cout << "Time to process a range of " << _vec.size() << " elements with std::vector : " << std::fixed << std::setprecision(5) << _vecTime << " us" << std::endl;
 		std::cout << "Time to process a range of " << _deq.size() << " elements with std::deque  : " << std::fixed << std::setprecision(5) << _deqTime << " us" << std::endl;
+		if (!_inputPath.empty())
+			printIngestTime(_vec.size(), _inputPath, ingestTime);
 	}
 	catch (std::exception &e)
 	{
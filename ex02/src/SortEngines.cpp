@@ -0,0 +1,38 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   SortEngines.cpp                                    :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: pol <pol@student.42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 11:20:49 by pol               #+#    #+#             */
+/*   Updated: 2026/10/19 11:20:49 by pol              ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "SortEngines.hpp"
+
+// Batcher's odd-even merge sort, written as the list of compare-exchanges
+static SortNetwork buildNetwork()
+{
+	SortNetwork net;
+	size_t n = NETWORK_SIZE;
+
+	net.size = 0;
+	for (size_t p = 1; p < n; p <<= 1)
+		for (size_t k = p; k >= 1; k >>= 1)
+			for (size_t j = k % p; j + k < n; j += 2 * k)
+				for (size_t i = 0; i < k && i + j + k < n; i++)
+					if ((i + j) / (2 * p) == (i + j + k) / (2 * p))
+					{
+						net.a[net.size] = static_cast<unsigned char>(i + j);
+						net.b[net.size] = static_cast<unsigned char>(i + j + k);
+						net.size++;
+					}
+	return net;
+}
+
+// Built during static initialisation, before any sorting thread exists
+static const SortNetwork g_network = buildNetwork();
+
+const SortNetwork &sortNetwork() { return g_network; }
@@ -11,17 +11,127 @@
 /* ************************************************************************** */
 
 #include "PmergeMe.hpp"
+#include <cstdlib>
 
+static bool parseEngine(const std::string &name, PmergeMe::Engine &engine)
+{
+	const PmergeMe::Engine all[] = {PmergeMe::ENGINE_AUTO, PmergeMe::ENGINE_MIN_COMPARISONS,
+									PmergeMe::ENGINE_RADIX, PmergeMe::ENGINE_NETWORK,
+									PmergeMe::ENGINE_INTROSORT};
+	for (size_t i = 0; i < sizeof(all) / sizeof(all[0]); i++)
+	{
+		if (name == PmergeMe::engineName(all[i]))
+		{
+			engine = all[i];
+			return true;
+		}
+	}
+	return false;
+}
+
+// "512M" -> bytes, 0 when invalid
+static size_t parseSize(const std::string &s)
+{
+	size_t digits = s.find_first_not_of("0123456789");
+	if (digits == 0 || s.size() > 8 || (digits != std::string::npos && digits + 1 != s.size()))
+		return 0;
+
+	size_t value = std::atol(s.c_str());
+	if (digits == std::string::npos)
+		return value;
+	switch (s[digits])
+	{
+	case 'K':
+		return value << 10;
+	case 'M':
+		return value << 20;
+	case 'G':
+		return value << 30;
+	}
+	return 0;
+}
+
+// Leading options, the rest of the arguments are the numbers to sort:
+//   -j N        sort with N threads
+//   -e ENGINE   auto, ford-johnson (default), radix, network or introsort
+//   -f FILE     read whitespace separated numbers from FILE ("-" for stdin)
+//   -b FILE     read raw little-endian int32 values from FILE
+//   -m SIZE     sort out of core within SIZE bytes (K, M or G suffix), needs -f or -b;
+//               runs are radix sorted unless -e picks another engine than ford-johnson
+//   -o FILE     where -m writes the sorted output ("-" for stdout)
+//   -r N        benchmark: N timed trials per container, min/median/p99
 int main(int ac, char **av)
 {
-	if (ac < 2)
+	PmergeMe sorter;
+	int shift = 0;
+	bool fromFile = false;
+	bool external = false;
+
+	while (shift + 2 < ac)
+	{
+		std::string opt(av[shift + 1]);
+		std::string arg(av[shift + 2]);
+		PmergeMe::Engine engine;
+
+		if (opt == "-j")
+		{
+			if (arg.empty() || arg.find_first_not_of("0123456789") != std::string::npos || arg.size() > 3)
+			{
+				std::cerr << "Error: invalid thread count." << std::endl;
+				return 1;
+			}
+			sorter.setThreads(std::atoi(arg.c_str()));
+		}
+		else if (opt == "-e")
+		{
+			if (!parseEngine(arg, engine))
+			{
+				std::cerr << "Error: unknown engine." << std::endl;
+				return 1;
+			}
+			sorter.setEngine(engine);
+		}
+		else if (opt == "-m")
+		{
+			size_t budget = parseSize(arg);
+			if (budget < (1 << 16))
+			{
+				std::cerr << "Error: invalid memory budget." << std::endl;
+				return 1;
+			}
+			sorter.setMemoryBudget(budget);
+			external = true;
+		}
+		else if (opt == "-r")
+		{
+			if (arg.empty() || arg.find_first_not_of("0123456789") != std::string::npos || arg.size() > 6
+				|| std::atoi(arg.c_str()) == 0)
+			{
+				std::cerr << "Error: invalid iteration count." << std::endl;
+				return 1;
+			}
+			sorter.setIterations(std::atoi(arg.c_str()));
+		}
+		else if (opt == "-o")
+			sorter.setOutputFile(arg);
+		else if (opt == "-f" || opt == "-b")
+		{
+			sorter.setInputFile(arg, opt == "-b");
+			fromFile = true;
+		}
+		else
+			break;
+		shift += 2;
+	}
+
+	if (fromFile ? ac - shift != 1 : (ac - shift < 2 || external))
 	{
 		std::cerr << "Error: Wrong number of arguments." << std::endl;
 		return 1;
 	}
 
-	PmergeMe sorter;
-	sorter.execute(ac, av);
+	// av[shift] stands in for the program name so execute still starts at 1
+	sorter.execute(ac - shift, av + shift);
 
 	return 0;
 }
\ No newline at end of file